@@ -1,7 +1,17 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <malloc.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 /**
  * @brief 根据 Node 指针，获取自定义 Type 指针
@@ -49,6 +59,9 @@ struct HashTable {
     int bktSize;
     int size;
     struct List *bkts;
+    struct HashArena *arena;
+    struct HashFilter *filter;
+    struct HashLog *log;
 };
 
 /**
@@ -60,6 +73,270 @@ struct HashNode {
     struct Node node;
 };
 
+/**
+ * @brief 内存池每块可容纳的 HashNode 个数
+ */
+#define HASH_ARENA_CHUNK_NODES 1024
+
+/**
+ * @brief 增量释放时每次调用默认处理的单位个数（节点、桶或内存池块）
+ */
+#define HASH_RECLAIM_BUDGET 1024
+
+/**
+ * @brief HashTable 内存池中的一块
+ */
+struct HashArenaChunk {
+    struct HashArenaChunk *next;
+    int used;
+    struct HashNode nodes[HASH_ARENA_CHUNK_NODES];
+};
+
+/**
+ * @brief HashTable 节点内存池，释放时按块整体归还，无需逐个遍历节点
+ */
+struct HashArena {
+    struct HashArenaChunk *chunks;
+    struct Node *freeList;
+};
+
+/**
+ * @brief 过滤器每个块的字节数（一个缓存行，128 个 4 位计数器）
+ */
+#define HASH_FILTER_BLOCK_BYTES 64
+#define HASH_FILTER_BLOCK_COUNTERS (HASH_FILTER_BLOCK_BYTES * 2)
+
+/**
+ * @brief 每个键在块内探测的计数器个数（分块后各块负载不均，比标准布隆过滤器的最优值少一个）
+ */
+#define HASH_FILTER_PROBES 5
+
+/**
+ * @brief 每个预期键分配的计数器个数（100 万个键时实测误判率约 0.7%）
+ */
+#define HASH_FILTER_COUNTERS_PER_KEY 14
+
+/**
+ * @brief 分块计数布隆过滤器，每个键只落在一个缓存行内，计数器支持删除，
+ *        饱和（15）后不再递减
+ */
+struct HashFilter {
+    unsigned char *blocks;
+    unsigned int blockCount;
+};
+
+/**
+ * @brief 批量聚合时每批预取的键个数
+ */
+#define HASH_AGGREGATE_BATCH 16
+
+/**
+ * @brief 批量聚合的输入（键, 增量）
+ */
+struct HashPair {
+    int key;
+    int val;
+};
+
+/**
+ * @brief 批量聚合的线程参数，每个线程拥有一个局部 HashTable
+ */
+struct HashAggregateTask {
+    struct HashTable partial;
+    const struct HashPair *pairs;
+    int count;
+    int (*combineFunc)(int, int);
+    bool ok;
+};
+
+/**
+ * @brief 日志记录类型
+ */
+#define HASH_LOG_PUT 1
+#define HASH_LOG_REMOVE 2
+
+/**
+ * @brief 日志记录字节数：类型(1) + 键(4) + 值(4) + 校验和(4)，按本机字节序存储
+ */
+#define HASH_LOG_RECORD_SIZE 13
+
+/**
+ * @brief 日志内存缓冲区大小（字节），写满时 HashPut 等待后台线程落盘
+ */
+#define HASH_LOG_BUFFER (256 * 1024)
+
+/**
+ * @brief 日志段超过该大小（字节）时切换新段并在后台压缩进快照
+ */
+#define HASH_LOG_COMPACT_SIZE (64ULL * 1024 * 1024)
+
+/**
+ * @brief 快照文件魔数
+ */
+#define HASH_LOG_SNAPSHOT_MAGIC 0x4e534c48U
+
+/**
+ * @brief 压缩时从日志段读出的一次修改，order 为其在日志中的先后
+ */
+struct HashLogOp {
+    int key;
+    int val;
+    unsigned long long order;
+    unsigned char type;
+};
+
+/**
+ * @brief HashTable 预写日志。HashPut / HashRemove 只把定长记录追加到内存缓冲区，
+ *        后台线程按 syncIntervalMs 成组写入 <path>.<seq>.log 并 fdatasync；
+ *        日志段过大时切换新段，由压缩线程与按键有序的快照文件 <path>.snap 归并后删除旧段
+ */
+struct HashLog {
+    char *path;
+    int fd;
+    unsigned long long seq;
+    unsigned long long segmentBytes;
+    unsigned long long compactBytes;
+    int syncIntervalMs;
+    unsigned char *buffer;
+    unsigned char *flushBuffer;
+    size_t used;
+    unsigned long long appended;
+    unsigned long long durable;
+    unsigned long long compactSeq;
+    unsigned long long snapshotSeq;
+    bool syncRequested;
+    bool stopping;
+    bool error;
+    pthread_mutex_t lock;
+    pthread_cond_t flushCond;
+    pthread_cond_t syncedCond;
+    pthread_cond_t compactCond;
+    pthread_t flushThread;
+    pthread_t compactThread;
+};
+
+/**
+ * @brief 待后台释放的 HashTable，桶数组及内存池已整体从原 HashTable 摘下
+ */
+struct HashReclaimJob {
+    struct List *bkts;
+    int bktSize;
+    int cursor;
+    struct HashArenaChunk *chunks;
+    struct HashReclaimJob *next;
+};
+
+/**
+ * @brief HashTable 延迟释放器，可启动后台线程释放，也可由调用方分批释放
+ */
+struct HashReclaimer {
+    struct HashReclaimJob *head;
+    struct HashReclaimJob *tail;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool background;
+    bool stopping;
+};
+
+/**
+ * @brief 写时复制 HashTable 中每个桶目录块包含的桶个数
+ */
+#define HASH_COW_FANOUT 64
+
+/**
+ * @brief 写时复制 HashTable 的键值对，发布后不再修改，可被多个版本共享
+ *        refs 为指向该节点的桶或前驱节点个数
+ */
+struct HashCowEntry {
+    int refs;
+    int key;
+    int val;
+    struct HashCowEntry *next;
+};
+
+/**
+ * @brief 写时复制 HashTable 的桶目录块，未改动的块在版本之间共享
+ */
+struct HashCowChunk {
+    int refs;
+    struct HashCowEntry *bkts[HASH_COW_FANOUT];
+};
+
+/**
+ * @brief 写时复制 HashTable 的一个版本，chunks 中为 NULL 的块表示其中所有桶为空
+ */
+struct HashCowVersion {
+    int refs;
+    int bktSize;
+    int size;
+    int chunkCount;
+    struct HashCowChunk *chunks[];
+};
+
+/**
+ * @brief 写时复制 HashTable，单个写线程修改当前版本，任意线程可取快照后无锁读取。
+ *        写操作期间 writing 为 true，当前版本可能被原地修改；pins 为正在取快照的读线程个数，
+ *        两者配合保证读线程不会在原地修改或旧版本回收的过程中取得版本
+ */
+struct HashCowTable {
+    struct HashCowVersion *version;
+    int pins;
+    bool writing;
+};
+
+/**
+ * @brief 延迟直方图每个数量级内的细分档位位数（4 位约 6% 相对误差）
+ */
+#define HASH_TRACE_SUB_BITS 4
+#define HASH_TRACE_SUB_COUNT (1 << HASH_TRACE_SUB_BITS)
+#define HASH_TRACE_BUCKETS (64 * HASH_TRACE_SUB_COUNT)
+
+/**
+ * @brief 被追踪的操作类型
+ */
+enum HashTraceOp
+{
+    HASH_TRACE_PUT,
+    HASH_TRACE_GET,
+    HASH_TRACE_REMOVE,
+    HASH_TRACE_FREE,
+    HASH_TRACE_OP_COUNT
+};
+
+#ifdef HASH_TRACE
+/**
+ * @brief 每个线程独占的 HDR 延迟直方图，只有所属线程写入，
+ *        首次使用时以无锁方式挂到全局链表上供 HashTraceDump 汇总；
+ *        线程退出后 used 置为 false，直方图（连同已记录的样本）交给之后新建的线程复用
+ */
+struct HashTraceThread
+{
+    unsigned long long counts[HASH_TRACE_OP_COUNT][HASH_TRACE_BUCKETS];
+    unsigned long long max[HASH_TRACE_OP_COUNT];
+    struct HashTraceThread *next;
+    bool used;
+};
+
+/**
+ * @brief 单次 API 调用的计时范围，离开作用域时自动记录耗时
+ */
+struct HashTraceScope
+{
+    enum HashTraceOp op;
+    unsigned long long start;
+};
+
+/**
+ * @brief 记录所在函数从此处到返回的耗时
+ * @param op 操作类型
+ */
+#define HASH_TRACE_SCOPE(op) \
+    struct HashTraceScope hashTraceScope __attribute__((cleanup(HashTraceScopeEnd))) = { (op), HashTraceNow() }
+#else
+#define HASH_TRACE_SCOPE(op)
+#endif
+
 /**
  * @brief 初始化链表
  * @param list 指向 List 的指针
@@ -140,6 +417,261 @@ void HashRemove(struct HashTable *hashTable, int key);
  */ 
 void HashFree(struct HashTable *hashTable);
 
+/**
+ * @brief 使用节点内存池的 HashTable 初始化，HashFree 时按块整体释放
+ * @param hashTable 指向 HashTable 的指针
+ * @param bktSize HashTable 中链表个数
+ * @return true 表示成功，false 表示失败
+ */
+bool HashInitArena(struct HashTable *hashTable, int bktSize);
+
+/**
+ * @brief 初始化 HashTable 延迟释放器
+ * @param reclaimer 指向 HashReclaimer 的指针
+ * @param background true 表示启动后台线程释放，false 表示由 HashReclaimStep 分批释放
+ * @return true 表示成功，false 表示失败
+ */
+bool HashReclaimerInit(struct HashReclaimer *reclaimer, bool background);
+
+/**
+ * @brief 异步释放 HashTable，O(1) 摘下桶数组后交给释放器
+ * @param reclaimer 指向 HashReclaimer 的指针
+ * @param hashTable 指向 HashTable 的指针
+ */
+void HashFreeAsync(struct HashReclaimer *reclaimer, struct HashTable *hashTable);
+
+/**
+ * @brief 分批释放延迟释放器中的 HashTable
+ * @param reclaimer 指向 HashReclaimer 的指针
+ * @param budget 本次最多处理的单位个数（节点、桶或内存池块）
+ * @return 本次实际处理的单位个数
+ */
+int HashReclaimStep(struct HashReclaimer *reclaimer, int budget);
+
+/**
+ * @brief 停止后台线程并释放所有剩余 HashTable
+ * @param reclaimer 指向 HashReclaimer 的指针
+ */
+void HashReclaimerDestroy(struct HashReclaimer *reclaimer);
+
+/**
+ * @brief 写时复制 HashTable 初始化
+ * @param table 指向 HashCowTable 的指针
+ * @param bktSize 桶个数（向上取整为 HASH_COW_FANOUT 的倍数）
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowInit(struct HashCowTable *table, int bktSize);
+
+/**
+ * @brief 向写时复制 HashTable 中添加键值对（若键已存在，则更新值）
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @param val 值
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowPut(struct HashCowTable *table, int key, int val);
+
+/**
+ * @brief 在写时复制 HashTable 当前版本中根据键获取对应值（可在任意线程中调用）
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @param saveVal 将获取到的值赋于该参数
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowGet(struct HashCowTable *table, int key, int *saveVal);
+
+/**
+ * @brief 删除写时复制 HashTable 中对应键值对
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @return true 表示成功（含键不存在），false 表示内存不足
+ */
+bool HashCowRemove(struct HashCowTable *table, int key);
+
+/**
+ * @brief O(1) 创建当前版本的快照，可在任意线程中调用（写操作进行中时短暂等待其完成）
+ * @param table 指向 HashCowTable 的指针
+ * @return 快照版本指针，之后的读取完全无锁，用完后调用 HashCowRelease
+ */
+struct HashCowVersion *HashCowSnapshot(struct HashCowTable *table);
+
+/**
+ * @brief 在快照版本中根据键获取对应值（无锁，可在任意线程中调用）
+ * @param version 快照版本指针
+ * @param key 键
+ * @param saveVal 将获取到的值赋于该参数
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowVersionGet(struct HashCowVersion *version, int key, int *saveVal);
+
+/**
+ * @brief 释放快照版本，最后一个引用释放时回收不再被共享的桶和节点
+ * @param version 快照版本指针
+ */
+void HashCowRelease(struct HashCowVersion *version);
+
+/**
+ * @brief 释放写时复制 HashTable（已取得的快照仍然有效，调用时不得有线程正在取快照）
+ * @param table 指向 HashCowTable 的指针
+ */
+void HashCowFree(struct HashCowTable *table);
+
+/**
+ * @brief 为 HashTable 挂载近似成员过滤器，HashGet 未命中时大多只需探测一个缓存行
+ * @param hashTable 指向 HashTable 的指针
+ * @param expectedKeys 预期键个数，用于确定过滤器大小
+ * @return true 表示成功，false 表示失败
+ */
+bool HashEnableFilter(struct HashTable *hashTable, int expectedKeys);
+
+/**
+ * @brief 卸载并释放 HashTable 的近似成员过滤器
+ * @param hashTable 指向 HashTable 的指针
+ */
+void HashDisableFilter(struct HashTable *hashTable);
+
+/**
+ * @brief 查找键对应的值，不存在时以 initVal 插入，只遍历一次桶
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param initVal 键不存在时插入的初始值
+ * @param inserted 保存是否新插入，可为 NULL
+ * @return 值的地址（可直接原地修改，键被删除前有效），失败时返回 NULL
+ */
+int *HashUpsert(struct HashTable *hashTable, int key, int initVal, bool *inserted);
+
+/**
+ * @brief 用合并函数原地更新键对应的值，键不存在时直接插入 val
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param val 参与合并的值
+ * @param combineFunc 合并函数，参数为旧值和 val，返回新值
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCombine(struct HashTable *hashTable, int key, int val, int (*combineFunc)(int, int));
+
+/**
+ * @brief 将 delta 累加到键对应的值上，键不存在时视为 0
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param delta 增量
+ * @return true 表示成功，false 表示失败
+ */
+bool HashAdd(struct HashTable *hashTable, int key, int delta);
+
+/**
+ * @brief 合并函数：求和
+ * @param oldVal 旧值
+ * @param val 新值
+ * @return oldVal + val
+ */
+int HashCombineAdd(int oldVal, int val);
+
+/**
+ * @brief 合并函数：取最小值
+ * @param oldVal 旧值
+ * @param val 新值
+ * @return 两者中较小者
+ */
+int HashCombineMin(int oldVal, int val);
+
+/**
+ * @brief 合并函数：取最大值
+ * @param oldVal 旧值
+ * @param val 新值
+ * @return 两者中较大者
+ */
+int HashCombineMax(int oldVal, int val);
+
+/**
+ * @brief 批量分组聚合，每个线程先聚合到各自的局部 HashTable，最后合并到 hashTable
+ * @param hashTable 指向 HashTable 的指针
+ * @param pairs （键, 增量）数组
+ * @param count 数组长度
+ * @param combineFunc 合并函数，多线程时须满足结合律和交换律
+ * @param threadCount 线程个数，小于等于 1 时在当前线程中聚合
+ * @return true 表示成功，false 表示失败（hashTable 可能已部分更新）
+ */
+bool HashAggregate(struct HashTable *hashTable, const struct HashPair *pairs, int count,
+                   int (*combineFunc)(int, int), int threadCount);
+
+/**
+ * @brief 从快照和日志段恢复 HashTable，须在 HashAttachLog 之前调用，
+ *        且同一路径上不能有已打开的 HashLog（后台压缩会删除正在重放的日志段）
+ * @param hashTable 指向已初始化 HashTable 的指针
+ * @param path 日志路径前缀
+ * @return true 表示成功（不存在任何文件时也返回 true），false 表示快照损坏或读取失败
+ */
+bool HashLogReplay(struct HashTable *hashTable, const char *path);
+
+/**
+ * @brief 打开预写日志，新建一个日志段并启动成组提交与后台压缩线程
+ * @param log 指向 HashLog 的指针
+ * @param path 日志路径前缀
+ * @param syncIntervalMs 成组提交间隔（毫秒），0 表示每次修改都等待落盘
+ * @param compactBytes 日志段超过该大小时压缩，0 表示使用默认值
+ * @return true 表示成功，false 表示失败
+ */
+bool HashLogOpen(struct HashLog *log, const char *path, int syncIntervalMs, unsigned long long compactBytes);
+
+/**
+ * @brief 为 HashTable 挂载预写日志，之后的 HashPut / HashRemove / HashCombine 都会先写日志再修改，
+ *        写日志失败时不修改 HashTable（通过 HashUpsert 返回的指针直接修改的值不会记录）；
+ *        syncIntervalMs 大于 0 时记录进入缓冲区即返回，之后落盘失败由 HashLogSync 报告，
+ *        此时内存中的修改已领先于日志
+ * @param hashTable 指向 HashTable 的指针
+ * @param log 指向 HashLog 的指针，为 NULL 时卸载
+ */
+void HashAttachLog(struct HashTable *hashTable, struct HashLog *log);
+
+/**
+ * @brief 等待此前追加的所有记录落盘
+ * @param log 指向 HashLog 的指针
+ * @return true 表示成功，false 表示写日志出错
+ */
+bool HashLogSync(struct HashLog *log);
+
+/**
+ * @brief 落盘剩余记录，停止后台线程并关闭日志
+ * @param log 指向 HashLog 的指针
+ * @return true 表示成功，false 表示写日志出错
+ */
+bool HashLogClose(struct HashLog *log);
+
+#ifdef HASH_TRACE
+/**
+ * @brief 获取当前时间戳（默认单位为纳秒，定义 HASH_TRACE_RDTSC 时为 CPU 周期）
+ * @return 时间戳
+ */
+unsigned long long HashTraceNow(void);
+
+/**
+ * @brief 计时范围结束时的回调，将耗时记入当前线程的直方图
+ * @param scope 计时范围指针
+ */
+void HashTraceScopeEnd(struct HashTraceScope *scope);
+
+/**
+ * @brief 汇总所有线程的直方图，获取指定操作的延迟分位数
+ * @param op 操作类型
+ * @param percentile 分位数（0 ~ 100，例如 99.9）
+ * @return 延迟上界，没有样本时返回 0
+ */
+unsigned long long HashTracePercentile(enum HashTraceOp op, double percentile);
+
+/**
+ * @brief 输出每种操作的样本数及 p50/p99/p999/max 延迟
+ * @param fp 输出文件指针
+ */
+void HashTraceDump(FILE *fp);
+
+/**
+ * @brief 清空所有线程的直方图（其他线程同时在记录时结果是近似的：
+ *        正在写入的样本可能丢失，也可能把清空前的计数写回）
+ */
+void HashTraceReset(void);
+#endif
+
 /**
  * @brief 初始化链表
  * @param list 指向 List 的指针
@@ -254,68 +786,2264 @@ bool HashInit(struct HashTable *hashTable, int bktSize)
     }
 
     hashTable->bktSize = bktSize;
+    hashTable->arena = NULL;
+    hashTable->filter = NULL;
+    hashTable->log = NULL;
 
     return true;
 }
 
 /**
- * @brief 向 HashTable 中添加键值对（若键已存在，则更新值）
+ * @brief 使用节点内存池的 HashTable 初始化，HashFree 时按块整体释放
  * @param hashTable 指向 HashTable 的指针
- * @param key 键
- * @param val 值
+ * @param bktSize HashTable 中链表个数
  * @return true 表示成功，false 表示失败
- */ 
-bool HashPut(struct HashTable *hashTable, int key, int val)
+ */
+bool HashInitArena(struct HashTable *hashTable, int bktSize)
 {
-    int position = 0;
-    struct HashNode *hashNode = NULL;
-    if (hashTable == NULL || hashTable->bkts == NULL) {
+    struct HashArena *arena = NULL;
+
+    arena = (struct HashArena *)malloc(sizeof(struct HashArena));
+    if (arena == NULL) {
+        return false;
+    }
+
+    if (!HashInit(hashTable, bktSize)) {
+        free(arena);
+        return false;
+    }
+
+    arena->chunks = NULL;
+    arena->freeList = NULL;
+    hashTable->arena = arena;
+
+    return true;
+}
+
+/**
+ * @brief 分配 HashTable 内部节点，使用内存池时从池中取
+ * @param hashTable 指向 HashTable 的指针
+ * @return 节点指针，失败时返回 NULL
+ */
+static struct HashNode *HashNodeAlloc(struct HashTable *hashTable)
+{
+    struct HashArena *arena = hashTable->arena;
+    struct HashArenaChunk *chunk = NULL;
+    struct Node *node = NULL;
+
+    if (arena == NULL) {
+        return (struct HashNode *)malloc(sizeof(struct HashNode));
+    }
+
+    if (arena->freeList != NULL) {
+        node = arena->freeList;
+        arena->freeList = node->next;
+        return NODE_ENTRY(node, struct HashNode, node);
+    }
+
+    chunk = arena->chunks;
+    if (chunk == NULL || chunk->used == HASH_ARENA_CHUNK_NODES) {
+        chunk = (struct HashArenaChunk *)malloc(sizeof(struct HashArenaChunk));
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+
+    return &chunk->nodes[chunk->used++];
+}
+
+/**
+ * @brief 归还 HashTable 内部节点，使用内存池时放回池中空闲链
+ * @param hashTable 指向 HashTable 的指针
+ * @param hashNode 节点指针
+ */
+static void HashNodeRelease(struct HashTable *hashTable, struct HashNode *hashNode)
+{
+    if (hashTable->arena == NULL) {
+        free(hashNode);
+        return;
+    }
+
+    hashNode->node.next = hashTable->arena->freeList;
+    hashTable->arena->freeList = &hashNode->node;
+}
+
+/**
+ * @brief 释放内存池块链
+ * @param chunk 第一个内存池块
+ */
+static void HashArenaFreeChunks(struct HashArenaChunk *chunk)
+{
+    struct HashArenaChunk *next = NULL;
+
+    while (chunk != NULL) {
+        next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+/**
+ * @brief 计算键在过滤器中的散列值
+ * @param key 键
+ * @return 64 位散列值
+ */
+static unsigned long long HashFilterMix(int key)
+{
+    unsigned long long h = (unsigned long long)(unsigned int)key;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+/**
+ * @brief 定位键所在的过滤器块，并得到块内双重散列的起点与步长
+ * @param filter 指向 HashFilter 的指针
+ * @param key 键
+ * @param start 保存块内第一个计数器下标
+ * @param step 保存块内探测步长（奇数，保证探测位置互不相同）
+ * @return 块首地址
+ */
+static unsigned char *HashFilterBlock(struct HashFilter *filter, int key, unsigned int *start, unsigned int *step)
+{
+    unsigned long long h = HashFilterMix(key);
+    unsigned long long block = ((h >> 32) * filter->blockCount) >> 32;
+
+    *start = (unsigned int)h & (HASH_FILTER_BLOCK_COUNTERS - 1);
+    *step = ((unsigned int)(h >> 8) & (HASH_FILTER_BLOCK_COUNTERS - 1)) | 1;
+
+    return filter->blocks + block * HASH_FILTER_BLOCK_BYTES;
+}
+
+/**
+ * @brief 将键加入过滤器
+ * @param filter 指向 HashFilter 的指针
+ * @param key 键
+ */
+static void HashFilterAdd(struct HashFilter *filter, int key)
+{
+    unsigned int start = 0;
+    unsigned int step = 0;
+    unsigned int slot = 0;
+    unsigned int counter = 0;
+    unsigned char *block = HashFilterBlock(filter, key, &start, &step);
+    int i = 0;
+
+    for (i = 0; i < HASH_FILTER_PROBES; i++) {
+        slot = (start + i * step) & (HASH_FILTER_BLOCK_COUNTERS - 1);
+        counter = (block[slot >> 1] >> ((slot & 1) * 4)) & 0xf;
+        if (counter < 0xf) {
+            block[slot >> 1] += (unsigned char)(1 << ((slot & 1) * 4));
+        }
+    }
+}
+
+/**
+ * @brief 将键从过滤器中删除
+ * @param filter 指向 HashFilter 的指针
+ * @param key 键
+ */
+static void HashFilterRemove(struct HashFilter *filter, int key)
+{
+    unsigned int start = 0;
+    unsigned int step = 0;
+    unsigned int slot = 0;
+    unsigned int counter = 0;
+    unsigned char *block = HashFilterBlock(filter, key, &start, &step);
+    int i = 0;
+
+    for (i = 0; i < HASH_FILTER_PROBES; i++) {
+        slot = (start + i * step) & (HASH_FILTER_BLOCK_COUNTERS - 1);
+        counter = (block[slot >> 1] >> ((slot & 1) * 4)) & 0xf;
+        if (counter > 0 && counter < 0xf) {
+            block[slot >> 1] -= (unsigned char)(1 << ((slot & 1) * 4));
+        }
+    }
+}
+
+/**
+ * @brief 判断键是否可能存在（false 表示一定不存在）
+ * @param filter 指向 HashFilter 的指针
+ * @param key 键
+ * @return true 表示可能存在，false 表示一定不存在
+ */
+static bool HashFilterContains(struct HashFilter *filter, int key)
+{
+    unsigned int start = 0;
+    unsigned int step = 0;
+    unsigned int slot = 0;
+    unsigned char *block = HashFilterBlock(filter, key, &start, &step);
+    int i = 0;
+
+    for (i = 0; i < HASH_FILTER_PROBES; i++) {
+        slot = (start + i * step) & (HASH_FILTER_BLOCK_COUNTERS - 1);
+        if (((block[slot >> 1] >> ((slot & 1) * 4)) & 0xf) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 为 HashTable 挂载近似成员过滤器，HashGet 未命中时大多只需探测一个缓存行
+ * @param hashTable 指向 HashTable 的指针
+ * @param expectedKeys 预期键个数，用于确定过滤器大小
+ * @return true 表示成功，false 表示失败
+ */
+bool HashEnableFilter(struct HashTable *hashTable, int expectedKeys)
+{
+    struct HashFilter *filter = NULL;
+    struct HashNode *hashNode = NULL;
+    unsigned long long blockCount = 0;
+    int i = 0;
+
+    if (hashTable == NULL || hashTable->bkts == NULL || expectedKeys < 0) {
+        return false;
+    }
+
+    blockCount = ((unsigned long long)expectedKeys * HASH_FILTER_COUNTERS_PER_KEY + HASH_FILTER_BLOCK_COUNTERS - 1) /
+                 HASH_FILTER_BLOCK_COUNTERS;
+    if (blockCount == 0) {
+        blockCount = 1;
+    }
+
+    filter = (struct HashFilter *)malloc(sizeof(struct HashFilter));
+    if (filter == NULL) {
+        return false;
+    }
+
+    filter->blocks = (unsigned char *)aligned_alloc(HASH_FILTER_BLOCK_BYTES, blockCount * HASH_FILTER_BLOCK_BYTES);
+    if (filter->blocks == NULL) {
+        free(filter);
+        return false;
+    }
+    memset(filter->blocks, 0, blockCount * HASH_FILTER_BLOCK_BYTES);
+    filter->blockCount = (unsigned int)blockCount;
+
+    for (i = 0; i < hashTable->bktSize; i++) {
+        LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[i], struct HashNode, node) {
+            HashFilterAdd(filter, hashNode->key);
+        }
+    }
+
+    HashDisableFilter(hashTable);
+    hashTable->filter = filter;
+
+    return true;
+}
+
+/**
+ * @brief 卸载并释放 HashTable 的近似成员过滤器
+ * @param hashTable 指向 HashTable 的指针
+ */
+void HashDisableFilter(struct HashTable *hashTable)
+{
+    if (hashTable == NULL || hashTable->filter == NULL) {
+        return;
+    }
+
+    free(hashTable->filter->blocks);
+    free(hashTable->filter);
+    hashTable->filter = NULL;
+}
+
+/**
+ * @brief 计算日志数据的校验和（FNV-1a）
+ * @param hash 初始值，首次计算传入 2166136261U
+ * @param data 数据
+ * @param len 数据长度
+ * @return 校验和
+ */
+static unsigned int HashLogChecksum(unsigned int hash, const unsigned char *data, size_t len)
+{
+    size_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 生成日志段文件路径 <path>.<seq>.log
+ * @param buf 保存路径的缓冲区
+ * @param size 缓冲区大小
+ * @param path 日志路径前缀
+ * @param seq 日志段序号
+ */
+static void HashLogSegmentPath(char *buf, size_t size, const char *path, unsigned long long seq)
+{
+    snprintf(buf, size, "%s.%llu.log", path, seq);
+}
+
+/**
+ * @brief 对文件所在目录执行 fsync，保证创建、改名、删除持久化
+ * @param path 文件路径
+ */
+static void HashLogSyncDir(const char *path)
+{
+    char buf[4096];
+    int fd = -1;
+
+    snprintf(buf, sizeof(buf), "%s", path);
+    fd = open(dirname(buf), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/**
+ * @brief 打开快照文件并读取头部
+ * @param path 日志路径前缀
+ * @param lastSeq 保存快照已包含的最后一个日志段序号
+ * @param count 保存快照中的键值对个数
+ * @param missing 保存快照是否不存在
+ * @return 定位到第一个键值对的文件指针，快照不存在或头部损坏时返回 NULL
+ */
+static FILE *HashLogOpenSnapshot(const char *path, unsigned long long *lastSeq, unsigned long long *count,
+                                 bool *missing)
+{
+    char buf[4096];
+    unsigned int magic = 0;
+    FILE *fp = NULL;
+
+    *lastSeq = 0;
+    *count = 0;
+    snprintf(buf, sizeof(buf), "%s.snap", path);
+    fp = fopen(buf, "rb");
+    *missing = fp == NULL && errno == ENOENT;
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    if (fread(&magic, sizeof(magic), 1, fp) != 1 || magic != HASH_LOG_SNAPSHOT_MAGIC ||
+        fread(lastSeq, sizeof(*lastSeq), 1, fp) != 1 || fread(count, sizeof(*count), 1, fp) != 1) {
+        fclose(fp);
+        *lastSeq = 0;
+        *count = 0;
+        return NULL;
+    }
+
+    return fp;
+}
+
+/**
+ * @brief 只读取快照头部，不加载键值对
+ * @param path 日志路径前缀
+ * @param lastSeq 保存快照已包含的最后一个日志段序号，没有快照时为 0
+ * @param count 保存快照中的键值对个数，没有快照时为 0
+ * @return true 表示成功（快照不存在也视为成功），false 表示快照头部损坏
+ */
+static bool HashLogReadSnapshotHeader(const char *path, unsigned long long *lastSeq, unsigned long long *count)
+{
+    bool missing = false;
+    FILE *fp = HashLogOpenSnapshot(path, lastSeq, count, &missing);
+
+    if (fp == NULL) {
+        return missing;
+    }
+
+    fclose(fp);
+    return true;
+}
+
+/**
+ * @brief 从快照中顺序读取下一个键值对并累加校验和
+ * @param fp 快照文件指针
+ * @param left 剩余键值对个数，读取后减一
+ * @param key 保存键
+ * @param val 保存值
+ * @param checksum 校验和
+ * @param ok 读取失败时置为 false
+ * @return true 表示读到一个键值对，false 表示已读完或读取失败
+ */
+static bool HashLogNextPair(FILE *fp, unsigned long long *left, int *key, int *val, unsigned int *checksum, bool *ok)
+{
+    unsigned char pair[8];
+
+    if (*left == 0) {
+        return false;
+    }
+    if (fread(pair, sizeof(pair), 1, fp) != 1) {
+        *ok = false;
+        return false;
+    }
+
+    (*left)--;
+    *checksum = HashLogChecksum(*checksum, pair, sizeof(pair));
+    memcpy(key, pair, sizeof(*key));
+    memcpy(val, pair + sizeof(*key), sizeof(*val));
+
+    return true;
+}
+
+/**
+ * @brief 校验快照尾部的校验和，校验范围为全部键值对之后依次是 lastSeq 与 count
+ * @param fp 定位到键值对之后的快照文件指针
+ * @param checksum 全部键值对的校验和
+ * @param lastSeq 快照头部的 lastSeq
+ * @param count 快照头部的 count
+ * @return true 表示校验通过，false 表示快照损坏
+ */
+static bool HashLogCheckSnapshot(FILE *fp, unsigned int checksum, unsigned long long lastSeq, unsigned long long count)
+{
+    unsigned int expect = 0;
+
+    checksum = HashLogChecksum(checksum, (unsigned char *)&lastSeq, sizeof(lastSeq));
+    checksum = HashLogChecksum(checksum, (unsigned char *)&count, sizeof(count));
+
+    return fread(&expect, sizeof(expect), 1, fp) == 1 && expect == checksum;
+}
+
+/**
+ * @brief 将快照文件加载到 HashTable
+ * @param hashTable 指向 HashTable 的指针
+ * @param path 日志路径前缀
+ * @param lastSeq 保存快照已包含的最后一个日志段序号，没有快照时为 0
+ * @return true 表示成功（快照不存在也视为成功），false 表示快照损坏
+ */
+static bool HashLogLoadSnapshot(struct HashTable *hashTable, const char *path, unsigned long long *lastSeq)
+{
+    unsigned int checksum = 2166136261U;
+    unsigned long long count = 0;
+    unsigned long long left = 0;
+    bool missing = false;
+    bool ok = true;
+    int key = 0;
+    int val = 0;
+    FILE *fp = NULL;
+
+    fp = HashLogOpenSnapshot(path, lastSeq, &count, &missing);
+    if (fp == NULL) {
+        return missing;
+    }
+
+    left = count;
+    while (ok && HashLogNextPair(fp, &left, &key, &val, &checksum, &ok)) {
+        ok = HashPut(hashTable, key, val);
+    }
+
+    ok = ok && HashLogCheckSnapshot(fp, checksum, *lastSeq, count);
+    fclose(fp);
+
+    return ok;
+}
+
+/**
+ * @brief 从日志段中读取下一条完整且校验通过的记录
+ * @param fp 日志段文件指针
+ * @param type 保存记录类型
+ * @param key 保存键
+ * @param val 保存值
+ * @return true 表示读到一条记录，false 表示已读完或遇到不完整、校验失败的记录（崩溃时写了一半）
+ */
+static bool HashLogReadRecord(FILE *fp, unsigned char *type, int *key, int *val)
+{
+    unsigned char record[HASH_LOG_RECORD_SIZE];
+    unsigned int checksum = 0;
+
+    if (fread(record, sizeof(record), 1, fp) != 1) {
+        return false;
+    }
+
+    memcpy(&checksum, record + 9, sizeof(checksum));
+    if (checksum != HashLogChecksum(2166136261U, record, 9) ||
+        (record[0] != HASH_LOG_PUT && record[0] != HASH_LOG_REMOVE)) {
+        return false;
+    }
+
+    *type = record[0];
+    memcpy(key, record + 1, sizeof(*key));
+    memcpy(val, record + 5, sizeof(*val));
+
+    return true;
+}
+
+/**
+ * @brief 重放一个日志段，遇到不完整或校验失败的记录即停止
+ * @param hashTable 指向 HashTable 的指针
+ * @param path 日志路径前缀
+ * @param seq 日志段序号
+ * @return true 表示日志段存在，false 表示不存在
+ */
+static bool HashLogReplaySegment(struct HashTable *hashTable, const char *path, unsigned long long seq)
+{
+    char buf[4096];
+    unsigned char type = 0;
+    int key = 0;
+    int val = 0;
+    FILE *fp = NULL;
+
+    HashLogSegmentPath(buf, sizeof(buf), path, seq);
+    fp = fopen(buf, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    while (HashLogReadRecord(fp, &type, &key, &val)) {
+        if (type == HASH_LOG_PUT) {
+            HashPut(hashTable, key, val);
+        } else {
+            HashRemove(hashTable, key);
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
+
+/**
+ * @brief 按键排序日志操作，同一个键按日志中的先后排序
+ * @param a 指向 HashLogOp 的指针
+ * @param b 指向 HashLogOp 的指针
+ * @return 小于、等于、大于 0 分别表示 a 排在 b 之前、相同、之后
+ */
+static int HashLogOpCompare(const void *a, const void *b)
+{
+    const struct HashLogOp *x = (const struct HashLogOp *)a;
+    const struct HashLogOp *y = (const struct HashLogOp *)b;
+
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+/**
+ * @brief 读取 (from, to] 之间的日志段，得到每个键最后一次修改并按键排序
+ * @param path 日志路径前缀
+ * @param from 当前快照包含的最后一个日志段序号
+ * @param to 本次合并到的日志段序号
+ * @param ops 保存操作数组，由调用方释放
+ * @param opCount 保存操作个数
+ * @return true 表示成功，false 表示内存不足
+ */
+static bool HashLogReadSegments(const char *path, unsigned long long from, unsigned long long to,
+                                struct HashLogOp **ops, size_t *opCount)
+{
+    struct HashLogOp *op = NULL;
+    struct stat st;
+    unsigned long long capacity = 0;
+    unsigned long long seq = 0;
+    unsigned char type = 0;
+    size_t count = 0;
+    size_t i = 0;
+    int key = 0;
+    int val = 0;
+    char buf[4096];
+    FILE *fp = NULL;
+
+    /* 日志段已全部落盘，按文件大小一次分配 */
+    for (seq = from + 1; seq <= to; seq++) {
+        HashLogSegmentPath(buf, sizeof(buf), path, seq);
+        if (stat(buf, &st) == 0) {
+            capacity += (unsigned long long)st.st_size / HASH_LOG_RECORD_SIZE;
+        }
+    }
+
+    *ops = NULL;
+    *opCount = 0;
+    if (capacity == 0) {
+        return true;
+    }
+    if (capacity > (size_t)-1 / sizeof(struct HashLogOp)) {
+        return false;
+    }
+    op = (struct HashLogOp *)malloc((size_t)capacity * sizeof(struct HashLogOp));
+    if (op == NULL) {
+        return false;
+    }
+
+    for (seq = from + 1; seq <= to; seq++) {
+        HashLogSegmentPath(buf, sizeof(buf), path, seq);
+        fp = fopen(buf, "rb");
+        if (fp == NULL) {
+            continue;
+        }
+        while (count < capacity && HashLogReadRecord(fp, &type, &key, &val)) {
+            op[count].key = key;
+            op[count].val = val;
+            op[count].order = count;
+            op[count].type = type;
+            count++;
+        }
+        fclose(fp);
+    }
+
+    qsort(op, count, sizeof(struct HashLogOp), HashLogOpCompare);
+    for (i = 0; i < count; i++) {
+        if (*opCount > 0 && op[*opCount - 1].key == op[i].key) {
+            op[*opCount - 1] = op[i];
+        } else {
+            op[(*opCount)++] = op[i];
+        }
+    }
+
+    *ops = op;
+    return true;
+}
+
+/**
+ * @brief 向新快照追加一个键值对
+ * @param fp 快照文件指针
+ * @param key 键
+ * @param val 值
+ * @param checksum 校验和
+ * @param count 已写入的键值对个数
+ * @return true 表示成功，false 表示写入失败
+ */
+static bool HashLogWritePair(FILE *fp, int key, int val, unsigned int *checksum, unsigned long long *count)
+{
+    unsigned char pair[8];
+
+    memcpy(pair, &key, sizeof(key));
+    memcpy(pair + sizeof(key), &val, sizeof(val));
+    *checksum = HashLogChecksum(*checksum, pair, sizeof(pair));
+    (*count)++;
+
+    return fwrite(pair, sizeof(pair), 1, fp) == 1;
+}
+
+/**
+ * @brief 将 (from, to] 之间的日志段合并进快照，成功后删除这些日志段。
+ *        快照按键有序，日志段中每个键的最后一次修改排序后与旧快照流式归并写出新快照
+ *        （先写临时文件再原子改名），内存占用只与日志段大小有关
+ * @param path 日志路径前缀
+ * @param from 当前快照包含的最后一个日志段序号
+ * @param to 本次合并到的日志段序号
+ * @return true 表示成功，false 表示失败
+ */
+static bool HashLogCompact(const char *path, unsigned long long from, unsigned long long to)
+{
+    struct HashLogOp *ops = NULL;
+    unsigned int magic = HASH_LOG_SNAPSHOT_MAGIC;
+    unsigned int inChecksum = 2166136261U;
+    unsigned int outChecksum = 2166136261U;
+    unsigned long long lastSeq = 0;
+    unsigned long long inCount = 0;
+    unsigned long long outCount = 0;
+    unsigned long long left = 0;
+    unsigned long long seq = 0;
+    size_t opCount = 0;
+    size_t i = 0;
+    bool missing = false;
+    bool hasPair = false;
+    bool skip = false;
+    bool ok = true;
+    int prevKey = 0;
+    int key = 0;
+    int val = 0;
+    char tmp[4096];
+    char buf[4096];
+    FILE *in = NULL;
+    FILE *out = NULL;
+
+    if (!HashLogReadSegments(path, from, to, &ops, &opCount)) {
+        return false;
+    }
+
+    in = HashLogOpenSnapshot(path, &lastSeq, &inCount, &missing);
+    if ((in == NULL && !missing) || lastSeq != from) {
+        if (in != NULL) {
+            fclose(in);
+        }
+        free(ops);
+        return false;
+    }
+
+    snprintf(tmp, sizeof(tmp), "%s.snap.tmp", path);
+    snprintf(buf, sizeof(buf), "%s.snap", path);
+    out = fopen(tmp, "wb");
+    if (out == NULL) {
+        if (in != NULL) {
+            fclose(in);
+        }
+        free(ops);
+        return false;
+    }
+
+    /* 键值对个数在归并结束后回填 */
+    ok = fwrite(&magic, sizeof(magic), 1, out) == 1 && fwrite(&to, sizeof(to), 1, out) == 1 &&
+         fwrite(&outCount, sizeof(outCount), 1, out) == 1;
+
+    left = inCount;
+    hasPair = in != NULL && HashLogNextPair(in, &left, &key, &val, &inChecksum, &ok);
+    while (ok && (hasPair || i < opCount)) {
+        if (i == opCount || (hasPair && key < ops[i].key)) {
+            ok = HashLogWritePair(out, key, val, &outChecksum, &outCount);
+            skip = true;
+        } else {
+            /* 日志中的修改覆盖快照中的同名键，删除的键不再写出 */
+            skip = hasPair && key == ops[i].key;
+            if (ops[i].type == HASH_LOG_PUT) {
+                ok = HashLogWritePair(out, ops[i].key, ops[i].val, &outChecksum, &outCount);
+            }
+            i++;
+        }
+
+        if (skip) {
+            prevKey = key;
+            hasPair = HashLogNextPair(in, &left, &key, &val, &inChecksum, &ok);
+            ok = ok && (!hasPair || key > prevKey);
+        }
+    }
+
+    if (in != NULL) {
+        ok = ok && HashLogCheckSnapshot(in, inChecksum, lastSeq, inCount);
+        fclose(in);
+    }
+    free(ops);
+
+    outChecksum = HashLogChecksum(outChecksum, (unsigned char *)&to, sizeof(to));
+    outChecksum = HashLogChecksum(outChecksum, (unsigned char *)&outCount, sizeof(outCount));
+    ok = ok && fwrite(&outChecksum, sizeof(outChecksum), 1, out) == 1;
+    ok = ok && fseek(out, (long)(sizeof(magic) + sizeof(to)), SEEK_SET) == 0 &&
+         fwrite(&outCount, sizeof(outCount), 1, out) == 1;
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+    ok = (fclose(out) == 0) && ok;
+    if (!ok || rename(tmp, buf) != 0) {
+        unlink(tmp);
+        return false;
+    }
+    HashLogSyncDir(buf);
+
+    for (seq = from + 1; seq <= to; seq++) {
+        HashLogSegmentPath(buf, sizeof(buf), path, seq);
+        unlink(buf);
+    }
+    HashLogSyncDir(path);
+
+    return true;
+}
+
+/**
+ * @brief 新建并打开日志段
+ * @param path 日志路径前缀
+ * @param seq 日志段序号
+ * @return 文件描述符，失败时返回 -1
+ */
+static int HashLogOpenSegment(const char *path, unsigned long long seq)
+{
+    char buf[4096];
+    int fd = -1;
+
+    HashLogSegmentPath(buf, sizeof(buf), path, seq);
+    fd = open(buf, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd >= 0) {
+        HashLogSyncDir(buf);
+    }
+
+    return fd;
+}
+
+/**
+ * @brief 成组提交线程：攒够 syncIntervalMs 或被要求同步时，交换缓冲区后整体写入并 fdatasync
+ * @param arg 指向 HashLog 的指针
+ * @return NULL
+ */
+static void *HashLogFlushThread(void *arg)
+{
+    struct HashLog *log = (struct HashLog *)arg;
+    struct timespec deadline;
+    unsigned char *tmp = NULL;
+    unsigned long long target = 0;
+    size_t size = 0;
+    size_t done = 0;
+    ssize_t n = 0;
+    bool ok = true;
+    int fd = -1;
+
+    pthread_mutex_lock(&log->lock);
+    while (true) {
+        if (log->used == 0) {
+            if (log->stopping) {
+                break;
+            }
+            pthread_cond_wait(&log->flushCond, &log->lock);
+            continue;
+        }
+
+        if (log->syncIntervalMs > 0 && !log->syncRequested && !log->stopping) {
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += log->syncIntervalMs / 1000;
+            deadline.tv_nsec += (long)(log->syncIntervalMs % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&log->flushCond, &log->lock, &deadline);
+        }
+
+        tmp = log->buffer;
+        log->buffer = log->flushBuffer;
+        log->flushBuffer = tmp;
+        size = log->used;
+        log->used = 0;
+        target = log->appended;
+        log->syncRequested = false;
+        pthread_cond_broadcast(&log->syncedCond);
+        pthread_mutex_unlock(&log->lock);
+
+        ok = true;
+        for (done = 0; done < size; done += (size_t)n) {
+            n = write(log->fd, log->flushBuffer + done, size - done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    n = 0;
+                    continue;
+                }
+                ok = false;
+                break;
+            }
+        }
+        ok = ok && fdatasync(log->fd) == 0;
+
+        /* 日志段过大时切换到新段，旧段交给压缩线程 */
+        log->segmentBytes += size;
+        fd = -1;
+        if (ok && log->segmentBytes >= log->compactBytes) {
+            fd = HashLogOpenSegment(log->path, log->seq + 1);
+            if (fd >= 0) {
+                close(log->fd);
+                log->fd = fd;
+                log->segmentBytes = 0;
+            }
+        }
+
+        pthread_mutex_lock(&log->lock);
+        if (!ok) {
+            log->error = true;
+        }
+        log->durable = target;
+        if (fd >= 0) {
+            log->compactSeq = log->seq;
+            log->seq++;
+            pthread_cond_signal(&log->compactCond);
+        }
+        pthread_cond_broadcast(&log->syncedCond);
+    }
+    pthread_mutex_unlock(&log->lock);
+
+    return NULL;
+}
+
+/**
+ * @brief 压缩线程：把已切换出去的日志段合并进快照，保证日志总量有界
+ * @param arg 指向 HashLog 的指针
+ * @return NULL
+ */
+static void *HashLogCompactThread(void *arg)
+{
+    struct HashLog *log = (struct HashLog *)arg;
+    unsigned long long failedSeq = 0;
+    unsigned long long from = 0;
+    unsigned long long to = 0;
+    bool ok = false;
+
+    pthread_mutex_lock(&log->lock);
+    while (true) {
+        while (!log->stopping && (log->compactSeq <= log->snapshotSeq || log->compactSeq == failedSeq)) {
+            pthread_cond_wait(&log->compactCond, &log->lock);
+        }
+        if (log->compactSeq <= log->snapshotSeq || log->compactSeq == failedSeq) {
+            break;
+        }
+
+        from = log->snapshotSeq;
+        to = log->compactSeq;
+        pthread_mutex_unlock(&log->lock);
+
+        ok = HashLogCompact(log->path, from, to);
+
+        pthread_mutex_lock(&log->lock);
+        if (ok) {
+            log->snapshotSeq = to;
+        } else {
+            /* 失败时保留日志段，等下一次切换日志段后重试 */
+            failedSeq = to;
+        }
+    }
+    pthread_mutex_unlock(&log->lock);
+
+    return NULL;
+}
+
+/**
+ * @brief 追加一条日志记录，syncIntervalMs 为 0 时等待其落盘
+ * @param log 指向 HashLog 的指针
+ * @param type 记录类型
+ * @param key 键
+ * @param val 值
+ * @return true 表示成功，false 表示写日志出错
+ */
+static bool HashLogAppend(struct HashLog *log, unsigned char type, int key, int val)
+{
+    unsigned char record[HASH_LOG_RECORD_SIZE];
+    unsigned long long mine = 0;
+    unsigned int checksum = 0;
+    bool ok = false;
+
+    record[0] = type;
+    memcpy(record + 1, &key, sizeof(key));
+    memcpy(record + 5, &val, sizeof(val));
+    checksum = HashLogChecksum(2166136261U, record, 9);
+    memcpy(record + 9, &checksum, sizeof(checksum));
+
+    pthread_mutex_lock(&log->lock);
+    while (!log->error && log->used + HASH_LOG_RECORD_SIZE > HASH_LOG_BUFFER) {
+        log->syncRequested = true;
+        pthread_cond_signal(&log->flushCond);
+        pthread_cond_wait(&log->syncedCond, &log->lock);
+    }
+
+    if (!log->error) {
+        memcpy(log->buffer + log->used, record, sizeof(record));
+        log->used += sizeof(record);
+        mine = ++log->appended;
+        if (log->used == sizeof(record) || log->syncIntervalMs == 0) {
+            log->syncRequested = log->syncRequested || log->syncIntervalMs == 0;
+            pthread_cond_signal(&log->flushCond);
+        }
+        while (log->syncIntervalMs == 0 && !log->error && log->durable < mine) {
+            pthread_cond_wait(&log->syncedCond, &log->lock);
+        }
+    }
+    ok = !log->error;
+    pthread_mutex_unlock(&log->lock);
+
+    return ok;
+}
+
+/**
+ * @brief 若 HashTable 挂载了日志，则追加一条记录
+ * @param hashTable 指向 HashTable 的指针
+ * @param type 记录类型
+ * @param key 键
+ * @param val 值
+ * @return true 表示成功或未挂载日志，false 表示写日志出错
+ */
+static bool HashLogRecord(struct HashTable *hashTable, unsigned char type, int key, int val)
+{
+    if (hashTable->log == NULL) {
+        return true;
+    }
+
+    return HashLogAppend(hashTable->log, type, key, val);
+}
+
+/**
+ * @brief 从快照和日志段恢复 HashTable，须在 HashAttachLog 之前调用，
+ *        且同一路径上不能有已打开的 HashLog（后台压缩会删除正在重放的日志段）
+ * @param hashTable 指向已初始化 HashTable 的指针
+ * @param path 日志路径前缀
+ * @return true 表示成功（不存在任何文件时也返回 true），false 表示快照损坏或读取失败
+ */
+bool HashLogReplay(struct HashTable *hashTable, const char *path)
+{
+    struct HashLog *log = NULL;
+    unsigned long long seq = 0;
+    bool ok = false;
+
+    if (hashTable == NULL || hashTable->bkts == NULL || path == NULL) {
+        return false;
+    }
+
+    log = hashTable->log;
+    hashTable->log = NULL;
+    ok = HashLogLoadSnapshot(hashTable, path, &seq);
+    if (ok) {
+        for (seq = seq + 1; HashLogReplaySegment(hashTable, path, seq); seq++) {
+        }
+    }
+    hashTable->log = log;
+
+    return ok;
+}
+
+/**
+ * @brief 打开预写日志，新建一个日志段并启动成组提交与后台压缩线程
+ * @param log 指向 HashLog 的指针
+ * @param path 日志路径前缀
+ * @param syncIntervalMs 成组提交间隔（毫秒），0 表示每次修改都等待落盘
+ * @param compactBytes 日志段超过该大小时压缩，0 表示使用默认值
+ * @return true 表示成功，false 表示失败
+ */
+bool HashLogOpen(struct HashLog *log, const char *path, int syncIntervalMs, unsigned long long compactBytes)
+{
+    char buf[4096];
+    unsigned long long snapshotSeq = 0;
+    unsigned long long count = 0;
+    unsigned long long seq = 0;
+
+    if (log == NULL || path == NULL || syncIntervalMs < 0) {
+        return false;
+    }
+
+    /* 只读取快照头部的序号，不需要真正加载数据 */
+    if (!HashLogReadSnapshotHeader(path, &snapshotSeq, &count)) {
+        return false;
+    }
+
+    /* 删除上次压缩成功但未来得及删除的旧日志段 */
+    for (seq = snapshotSeq; seq > 0; seq--) {
+        HashLogSegmentPath(buf, sizeof(buf), path, seq);
+        if (unlink(buf) != 0) {
+            break;
+        }
+    }
+
+    /* 跳过已存在的日志段，新记录写入一个全新的日志段 */
+    seq = snapshotSeq + 1;
+    while (true) {
+        HashLogSegmentPath(buf, sizeof(buf), path, seq);
+        if (access(buf, F_OK) != 0) {
+            break;
+        }
+        seq++;
+    }
+
+    memset(log, 0, sizeof(*log));
+    log->path = strdup(path);
+    log->buffer = (unsigned char *)malloc(HASH_LOG_BUFFER);
+    log->flushBuffer = (unsigned char *)malloc(HASH_LOG_BUFFER);
+    log->fd = -1;
+    if (log->path == NULL || log->buffer == NULL || log->flushBuffer == NULL) {
+        goto fail;
+    }
+
+    log->fd = HashLogOpenSegment(path, seq);
+    if (log->fd < 0) {
+        goto fail;
+    }
+
+    log->seq = seq;
+    log->compactBytes = compactBytes == 0 ? HASH_LOG_COMPACT_SIZE : compactBytes;
+    log->syncIntervalMs = syncIntervalMs;
+    log->snapshotSeq = snapshotSeq;
+    log->compactSeq = snapshotSeq;
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->flushCond, NULL);
+    pthread_cond_init(&log->syncedCond, NULL);
+    pthread_cond_init(&log->compactCond, NULL);
+
+    if (pthread_create(&log->flushThread, NULL, HashLogFlushThread, log) != 0) {
+        goto fail_sync;
+    }
+    if (pthread_create(&log->compactThread, NULL, HashLogCompactThread, log) != 0) {
+        pthread_mutex_lock(&log->lock);
+        log->stopping = true;
+        pthread_cond_signal(&log->flushCond);
+        pthread_mutex_unlock(&log->lock);
+        pthread_join(log->flushThread, NULL);
+        goto fail_sync;
+    }
+
+    return true;
+
+fail_sync:
+    pthread_cond_destroy(&log->compactCond);
+    pthread_cond_destroy(&log->syncedCond);
+    pthread_cond_destroy(&log->flushCond);
+    pthread_mutex_destroy(&log->lock);
+fail:
+    if (log->fd >= 0) {
+        close(log->fd);
+    }
+    free(log->flushBuffer);
+    free(log->buffer);
+    free(log->path);
+    return false;
+}
+
+/**
+ * @brief 为 HashTable 挂载预写日志，之后的 HashPut / HashRemove / HashCombine 都会先写日志再修改，
+ *        写日志失败时不修改 HashTable（通过 HashUpsert 返回的指针直接修改的值不会记录）；
+ *        syncIntervalMs 大于 0 时记录进入缓冲区即返回，之后落盘失败由 HashLogSync 报告，
+ *        此时内存中的修改已领先于日志
+ * @param hashTable 指向 HashTable 的指针
+ * @param log 指向 HashLog 的指针，为 NULL 时卸载
+ */
+void HashAttachLog(struct HashTable *hashTable, struct HashLog *log)
+{
+    if (hashTable == NULL) {
+        return;
+    }
+
+    hashTable->log = log;
+}
+
+/**
+ * @brief 等待此前追加的所有记录落盘
+ * @param log 指向 HashLog 的指针
+ * @return true 表示成功，false 表示写日志出错
+ */
+bool HashLogSync(struct HashLog *log)
+{
+    unsigned long long target = 0;
+    bool ok = false;
+
+    if (log == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&log->lock);
+    target = log->appended;
+    if (log->durable < target) {
+        log->syncRequested = true;
+        pthread_cond_signal(&log->flushCond);
+    }
+    while (!log->error && log->durable < target) {
+        pthread_cond_wait(&log->syncedCond, &log->lock);
+    }
+    ok = !log->error;
+    pthread_mutex_unlock(&log->lock);
+
+    return ok;
+}
+
+/**
+ * @brief 落盘剩余记录，停止后台线程并关闭日志
+ * @param log 指向 HashLog 的指针
+ * @return true 表示成功，false 表示写日志出错
+ */
+bool HashLogClose(struct HashLog *log)
+{
+    bool ok = false;
+
+    if (log == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&log->lock);
+    log->stopping = true;
+    pthread_cond_signal(&log->flushCond);
+    pthread_cond_signal(&log->compactCond);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->flushThread, NULL);
+    pthread_join(log->compactThread, NULL);
+
+    ok = !log->error;
+    close(log->fd);
+    pthread_cond_destroy(&log->compactCond);
+    pthread_cond_destroy(&log->syncedCond);
+    pthread_cond_destroy(&log->flushCond);
+    pthread_mutex_destroy(&log->lock);
+    free(log->flushBuffer);
+    free(log->buffer);
+    free(log->path);
+    log->flushBuffer = NULL;
+    log->buffer = NULL;
+    log->path = NULL;
+    log->fd = -1;
+
+    return ok;
+}
+
+/**
+ * @brief 向 HashTable 中添加键值对（若键已存在，则更新值）
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param val 值
+ * @return true 表示成功，false 表示失败
+ */ 
+bool HashPut(struct HashTable *hashTable, int key, int val)
+{
+    int position = 0;
+    struct HashNode *hashNode = NULL;
+    HASH_TRACE_SCOPE(HASH_TRACE_PUT);
+    if (hashTable == NULL || hashTable->bkts == NULL) {
         return false;
     }
 
     position = HashPositionFunc(hashTable, key);
     LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[position], struct HashNode, node) {
         if (hashNode->key == key) {
+            if (!HashLogRecord(hashTable, HASH_LOG_PUT, key, val)) {
+                return false;
+            }
             hashNode->val = val;
             return true;
         }
     }
 
-    hashNode = (struct HashNode *)malloc(sizeof(struct HashNode));
-    if (hashNode == NULL) {
+    hashNode = HashNodeAlloc(hashTable);
+    if (hashNode == NULL) {
+        return false;
+    }
+    if (!HashLogRecord(hashTable, HASH_LOG_PUT, key, val)) {
+        HashNodeRelease(hashTable, hashNode);
+        return false;
+    }
+    hashNode->key = key;
+    hashNode->val = val;
+
+    ListAddTail(&hashTable->bkts[position], &hashNode->node);
+    if (hashTable->filter != NULL) {
+        HashFilterAdd(hashTable->filter, key);
+    }
+
+    return true;
+}
+
+/**
+ * @brief 在 HashTable 中根据键获取对应值
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param saveVal 将获取到的值赋于该参数
+ * @return true 表示成功，false 表示失败
+ */ 
+bool HashGet(struct HashTable *hashTable, int key, int *saveVal)
+{
+    int position = 0;
+    struct HashNode *hashNode = NULL;
+    HASH_TRACE_SCOPE(HASH_TRACE_GET);
+    if (hashTable == NULL || hashTable->bkts == NULL) {
+        return false;
+    }
+
+    if (hashTable->filter != NULL && !HashFilterContains(hashTable->filter, key)) {
+        return false;
+    }
+
+    position = HashPositionFunc(hashTable, key);
+    if (ListIsEmpty(&hashTable->bkts[position])) {
+        return false;
+    }
+
+    LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[position], struct HashNode, node) {
+        if (hashNode->key == key) {
+            *saveVal = hashNode->val;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief 删除 HashTable 中对应键值对
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ */ 
+void HashRemove(struct HashTable *hashTable, int key)
+{
+    int position = 0;
+    struct HashNode *hashNode = NULL;
+    struct Node *prev = NULL;
+    struct Node *next = NULL;
+    HASH_TRACE_SCOPE(HASH_TRACE_REMOVE);
+    if (hashTable == NULL || hashTable->bkts == NULL) {
+        return;
+    }
+
+    position = HashPositionFunc(hashTable, key);
+    if (ListIsEmpty(&hashTable->bkts[position])) {
+        return;
+    }
+
+    LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[position], struct HashNode, node) {
+        if (hashNode->key == key) {
+            if (!HashLogRecord(hashTable, HASH_LOG_REMOVE, key, 0)) {
+                return;
+            }
+            prev = hashNode->node.prev;
+            next = hashNode->node.next;
+            prev->next = next;
+            next->prev = prev;
+            HashNodeRelease(hashTable, hashNode);
+            if (hashTable->filter != NULL) {
+                HashFilterRemove(hashTable->filter, key);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 查找键对应的值，不存在时以 initVal 插入，只遍历一次桶
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param initVal 键不存在时插入的初始值
+ * @param inserted 保存是否新插入，可为 NULL
+ * @return 值的地址（可直接原地修改，键被删除前有效），失败时返回 NULL
+ */
+int *HashUpsert(struct HashTable *hashTable, int key, int initVal, bool *inserted)
+{
+    int position = 0;
+    struct HashNode *hashNode = NULL;
+    if (hashTable == NULL || hashTable->bkts == NULL) {
+        return NULL;
+    }
+
+    if (inserted != NULL) {
+        *inserted = false;
+    }
+
+    position = HashPositionFunc(hashTable, key);
+    LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[position], struct HashNode, node) {
+        if (hashNode->key == key) {
+            return &hashNode->val;
+        }
+    }
+
+    hashNode = HashNodeAlloc(hashTable);
+    if (hashNode == NULL) {
+        return NULL;
+    }
+    if (!HashLogRecord(hashTable, HASH_LOG_PUT, key, initVal)) {
+        HashNodeRelease(hashTable, hashNode);
+        return NULL;
+    }
+    hashNode->key = key;
+    hashNode->val = initVal;
+
+    ListAddTail(&hashTable->bkts[position], &hashNode->node);
+    if (hashTable->filter != NULL) {
+        HashFilterAdd(hashTable->filter, key);
+    }
+
+    if (inserted != NULL) {
+        *inserted = true;
+    }
+
+    return &hashNode->val;
+}
+
+/**
+ * @brief 用合并函数原地更新键对应的值，键不存在时直接插入 val
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param val 参与合并的值
+ * @param combineFunc 合并函数，参数为旧值和 val，返回新值
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCombine(struct HashTable *hashTable, int key, int val, int (*combineFunc)(int, int))
+{
+    int *slot = NULL;
+    int newVal = 0;
+    bool inserted = false;
+
+    if (combineFunc == NULL) {
+        return false;
+    }
+
+    slot = HashUpsert(hashTable, key, val, &inserted);
+    if (slot == NULL) {
+        return false;
+    }
+
+    if (inserted) {
+        return true;
+    }
+
+    newVal = combineFunc(*slot, val);
+    if (!HashLogRecord(hashTable, HASH_LOG_PUT, key, newVal)) {
+        return false;
+    }
+    *slot = newVal;
+
+    return true;
+}
+
+/**
+ * @brief 将 delta 累加到键对应的值上，键不存在时视为 0
+ * @param hashTable 指向 HashTable 的指针
+ * @param key 键
+ * @param delta 增量
+ * @return true 表示成功，false 表示失败
+ */
+bool HashAdd(struct HashTable *hashTable, int key, int delta)
+{
+    return HashCombine(hashTable, key, delta, HashCombineAdd);
+}
+
+/**
+ * @brief 合并函数：求和
+ * @param oldVal 旧值
+ * @param val 新值
+ * @return oldVal + val
+ */
+int HashCombineAdd(int oldVal, int val)
+{
+    return oldVal + val;
+}
+
+/**
+ * @brief 合并函数：取最小值
+ * @param oldVal 旧值
+ * @param val 新值
+ * @return 两者中较小者
+ */
+int HashCombineMin(int oldVal, int val)
+{
+    return val < oldVal ? val : oldVal;
+}
+
+/**
+ * @brief 合并函数：取最大值
+ * @param oldVal 旧值
+ * @param val 新值
+ * @return 两者中较大者
+ */
+int HashCombineMax(int oldVal, int val)
+{
+    return val > oldVal ? val : oldVal;
+}
+
+/**
+ * @brief 按批聚合一段输入：先预取整批键对应的桶头和首节点，再逐个合并
+ * @param hashTable 指向 HashTable 的指针
+ * @param pairs （键, 增量）数组
+ * @param count 数组长度
+ * @param combineFunc 合并函数
+ * @return true 表示成功，false 表示失败
+ */
+static bool HashAggregateRange(struct HashTable *hashTable, const struct HashPair *pairs, int count,
+                               int (*combineFunc)(int, int))
+{
+    struct List *bkts[HASH_AGGREGATE_BATCH];
+    int batch = 0;
+    int i = 0;
+    int j = 0;
+
+    for (i = 0; i < count; i += HASH_AGGREGATE_BATCH) {
+        batch = count - i < HASH_AGGREGATE_BATCH ? count - i : HASH_AGGREGATE_BATCH;
+        for (j = 0; j < batch; j++) {
+            bkts[j] = &hashTable->bkts[HashPositionFunc(hashTable, pairs[i + j].key)];
+            __builtin_prefetch(bkts[j]);
+        }
+        for (j = 0; j < batch; j++) {
+            __builtin_prefetch(bkts[j]->base.next);
+        }
+        for (j = 0; j < batch; j++) {
+            if (!HashCombine(hashTable, pairs[i + j].key, pairs[i + j].val, combineFunc)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 批量聚合线程
+ * @param arg 指向 HashAggregateTask 的指针
+ * @return NULL
+ */
+static void *HashAggregateThread(void *arg)
+{
+    struct HashAggregateTask *task = (struct HashAggregateTask *)arg;
+
+    task->ok = HashAggregateRange(&task->partial, task->pairs, task->count, task->combineFunc);
+
+    return NULL;
+}
+
+/**
+ * @brief 批量分组聚合，每个线程先聚合到各自的局部 HashTable，最后合并到 hashTable
+ * @param hashTable 指向 HashTable 的指针
+ * @param pairs （键, 增量）数组
+ * @param count 数组长度
+ * @param combineFunc 合并函数，多线程时须满足结合律和交换律
+ * @param threadCount 线程个数，小于等于 1 时在当前线程中聚合
+ * @return true 表示成功，false 表示失败（hashTable 可能已部分更新）
+ */
+bool HashAggregate(struct HashTable *hashTable, const struct HashPair *pairs, int count,
+                   int (*combineFunc)(int, int), int threadCount)
+{
+    struct HashAggregateTask *tasks = NULL;
+    pthread_t *threads = NULL;
+    struct HashNode *hashNode = NULL;
+    bool ok = true;
+    int started = 0;
+    int begin = 0;
+    int i = 0;
+    int j = 0;
+
+    if (hashTable == NULL || hashTable->bkts == NULL || pairs == NULL || count < 0 || combineFunc == NULL) {
+        return false;
+    }
+
+    if (threadCount <= 1 || count < threadCount * HASH_AGGREGATE_BATCH) {
+        return HashAggregateRange(hashTable, pairs, count, combineFunc);
+    }
+
+    tasks = (struct HashAggregateTask *)malloc(sizeof(struct HashAggregateTask) * threadCount);
+    threads = (pthread_t *)malloc(sizeof(pthread_t) * threadCount);
+    if (tasks == NULL || threads == NULL) {
+        free(tasks);
+        free(threads);
+        return false;
+    }
+
+    for (i = 0; i < threadCount; i++) {
+        tasks[i].pairs = pairs + begin;
+        tasks[i].count = count / threadCount + (i < count % threadCount ? 1 : 0);
+        tasks[i].combineFunc = combineFunc;
+        tasks[i].ok = false;
+        begin += tasks[i].count;
+        if (!HashInit(&tasks[i].partial, hashTable->bktSize)) {
+            ok = false;
+            break;
+        }
+        if (pthread_create(&threads[i], NULL, HashAggregateThread, &tasks[i]) != 0) {
+            HashFree(&tasks[i].partial);
+            ok = false;
+            break;
+        }
+        started++;
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* 将各线程的局部结果合并到目标 HashTable */
+    for (i = 0; i < started; i++) {
+        ok = ok && tasks[i].ok;
+        for (j = 0; ok && j < tasks[i].partial.bktSize; j++) {
+            LIST_FOR_EACH_ENTRY(hashNode, &tasks[i].partial.bkts[j], struct HashNode, node) {
+                if (!HashCombine(hashTable, hashNode->key, hashNode->val, combineFunc)) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        HashFree(&tasks[i].partial);
+    }
+
+    free(tasks);
+    free(threads);
+
+    return ok;
+}
+
+/**
+ * @brief 释放 HashTable
+ * @param hashTable 指向 HashTable 的指针
+ */ 
+void HashFree(struct HashTable *hashTable)
+{
+    int i = 0;
+    HASH_TRACE_SCOPE(HASH_TRACE_FREE);
+    if (hashTable == NULL || hashTable->bkts == NULL) {
+        return;
+    }
+
+    if (hashTable->arena != NULL) {
+        /* 节点都在内存池中，按块整体释放即可 */
+        HashArenaFreeChunks(hashTable->arena->chunks);
+        free(hashTable->arena);
+        hashTable->arena = NULL;
+    } else {
+        for (i = 0; i < hashTable->bktSize; i++) {
+            ListFree(&hashTable->bkts[i], HashNodeFreeFunc);
+        }
+    }
+
+    free(hashTable->bkts);
+    hashTable->bkts = NULL;
+    HashDisableFilter(hashTable);
+}
+
+/**
+ * @brief 后台释放线程
+ * @param arg 指向 HashReclaimer 的指针
+ * @return NULL
+ */
+static void *HashReclaimThread(void *arg)
+{
+    struct HashReclaimer *reclaimer = (struct HashReclaimer *)arg;
+
+    while (true) {
+        pthread_mutex_lock(&reclaimer->lock);
+        while (reclaimer->head == NULL && !reclaimer->stopping) {
+            pthread_cond_wait(&reclaimer->cond, &reclaimer->lock);
+        }
+        if (reclaimer->head == NULL) {
+            pthread_mutex_unlock(&reclaimer->lock);
+            break;
+        }
+        pthread_mutex_unlock(&reclaimer->lock);
+
+        HashReclaimStep(reclaimer, HASH_RECLAIM_BUDGET);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 初始化 HashTable 延迟释放器
+ * @param reclaimer 指向 HashReclaimer 的指针
+ * @param background true 表示启动后台线程释放，false 表示由 HashReclaimStep 分批释放
+ * @return true 表示成功，false 表示失败
+ */
+bool HashReclaimerInit(struct HashReclaimer *reclaimer, bool background)
+{
+    if (reclaimer == NULL) {
+        return false;
+    }
+
+    reclaimer->head = NULL;
+    reclaimer->tail = NULL;
+    reclaimer->background = false;
+    reclaimer->stopping = false;
+    if (pthread_mutex_init(&reclaimer->lock, NULL) != 0) {
+        return false;
+    }
+    if (pthread_cond_init(&reclaimer->cond, NULL) != 0) {
+        pthread_mutex_destroy(&reclaimer->lock);
+        return false;
+    }
+
+    if (background) {
+        if (pthread_create(&reclaimer->thread, NULL, HashReclaimThread, reclaimer) != 0) {
+            pthread_cond_destroy(&reclaimer->cond);
+            pthread_mutex_destroy(&reclaimer->lock);
+            return false;
+        }
+        reclaimer->background = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 异步释放 HashTable，O(1) 摘下桶数组后交给释放器
+ * @param reclaimer 指向 HashReclaimer 的指针
+ * @param hashTable 指向 HashTable 的指针
+ */
+void HashFreeAsync(struct HashReclaimer *reclaimer, struct HashTable *hashTable)
+{
+    struct HashReclaimJob *job = NULL;
+
+    if (reclaimer == NULL || hashTable == NULL || hashTable->bkts == NULL) {
+        return;
+    }
+
+    job = (struct HashReclaimJob *)malloc(sizeof(struct HashReclaimJob));
+    if (job == NULL) {
+        HashFree(hashTable);
+        return;
+    }
+
+    job->bkts = hashTable->bkts;
+    job->bktSize = hashTable->bktSize;
+    job->cursor = 0;
+    job->chunks = NULL;
+    job->next = NULL;
+    if (hashTable->arena != NULL) {
+        /* 节点都在内存池中，桶链表无需逐个遍历 */
+        job->chunks = hashTable->arena->chunks;
+        job->cursor = job->bktSize;
+        free(hashTable->arena);
+        hashTable->arena = NULL;
+    }
+    hashTable->bkts = NULL;
+    HashDisableFilter(hashTable);
+
+    pthread_mutex_lock(&reclaimer->lock);
+    if (reclaimer->tail == NULL) {
+        reclaimer->head = job;
+    } else {
+        reclaimer->tail->next = job;
+    }
+    reclaimer->tail = job;
+    pthread_cond_signal(&reclaimer->cond);
+    pthread_mutex_unlock(&reclaimer->lock);
+}
+
+/**
+ * @brief 分批释放延迟释放器中的 HashTable
+ * @param reclaimer 指向 HashReclaimer 的指针
+ * @param budget 本次最多处理的单位个数（节点、桶或内存池块）
+ * @return 本次实际处理的单位个数
+ */
+int HashReclaimStep(struct HashReclaimer *reclaimer, int budget)
+{
+    struct HashReclaimJob *job = NULL;
+    struct HashArenaChunk *chunk = NULL;
+    struct List *list = NULL;
+    struct Node *node = NULL;
+    int done = 0;
+
+    if (reclaimer == NULL) {
+        return 0;
+    }
+
+    while (done < budget) {
+        pthread_mutex_lock(&reclaimer->lock);
+        job = reclaimer->head;
+        if (job != NULL) {
+            reclaimer->head = job->next;
+            if (reclaimer->head == NULL) {
+                reclaimer->tail = NULL;
+            }
+        }
+        pthread_mutex_unlock(&reclaimer->lock);
+
+        if (job == NULL) {
+            break;
+        }
+
+        while (done < budget && job->cursor < job->bktSize) {
+            list = &job->bkts[job->cursor];
+            node = list->base.next;
+            if (node == &list->base) {
+                job->cursor++;
+            } else {
+                list->base.next = node->next;
+                HashNodeFreeFunc(node);
+            }
+            done++;
+        }
+
+        while (done < budget && job->cursor == job->bktSize && job->chunks != NULL) {
+            chunk = job->chunks;
+            job->chunks = chunk->next;
+            free(chunk);
+            done++;
+        }
+
+        if (job->cursor == job->bktSize && job->chunks == NULL) {
+            free(job->bkts);
+            free(job);
+            continue;
+        }
+
+        /* 预算用完，未释放完的 HashTable 放回队首，下次继续 */
+        pthread_mutex_lock(&reclaimer->lock);
+        job->next = reclaimer->head;
+        reclaimer->head = job;
+        if (reclaimer->tail == NULL) {
+            reclaimer->tail = job;
+        }
+        pthread_mutex_unlock(&reclaimer->lock);
+    }
+
+    return done;
+}
+
+/**
+ * @brief 停止后台线程并释放所有剩余 HashTable
+ * @param reclaimer 指向 HashReclaimer 的指针
+ */
+void HashReclaimerDestroy(struct HashReclaimer *reclaimer)
+{
+    if (reclaimer == NULL) {
+        return;
+    }
+
+    if (reclaimer->background) {
+        pthread_mutex_lock(&reclaimer->lock);
+        reclaimer->stopping = true;
+        pthread_cond_signal(&reclaimer->cond);
+        pthread_mutex_unlock(&reclaimer->lock);
+        pthread_join(reclaimer->thread, NULL);
+        reclaimer->background = false;
+    }
+
+    while (HashReclaimStep(reclaimer, HASH_RECLAIM_BUDGET) > 0) {
+    }
+
+    pthread_cond_destroy(&reclaimer->cond);
+    pthread_mutex_destroy(&reclaimer->lock);
+}
+
+/**
+ * @brief 释放节点引用，引用归零时释放节点并继续释放其后继
+ * @param entry 节点指针
+ */
+static void HashCowEntryRelease(struct HashCowEntry *entry)
+{
+    struct HashCowEntry *next = NULL;
+
+    while (entry != NULL && __atomic_sub_fetch(&entry->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        next = entry->next;
+        free(entry);
+        entry = next;
+    }
+}
+
+/**
+ * @brief 释放桶目录块引用，引用归零时释放块及其中所有桶
+ * @param chunk 桶目录块指针
+ */
+static void HashCowChunkRelease(struct HashCowChunk *chunk)
+{
+    int i = 0;
+
+    if (chunk == NULL || __atomic_sub_fetch(&chunk->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    for (i = 0; i < HASH_COW_FANOUT; i++) {
+        HashCowEntryRelease(chunk->bkts[i]);
+    }
+    free(chunk);
+}
+
+/**
+ * @brief 写时复制 HashTable 初始化
+ * @param table 指向 HashCowTable 的指针
+ * @param bktSize 桶个数（向上取整为 HASH_COW_FANOUT 的倍数）
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowInit(struct HashCowTable *table, int bktSize)
+{
+    struct HashCowVersion *version = NULL;
+    int chunkCount = 0;
+    int i = 0;
+
+    if (table == NULL || bktSize <= 0) {
+        return false;
+    }
+
+    chunkCount = (bktSize + HASH_COW_FANOUT - 1) / HASH_COW_FANOUT;
+    version = (struct HashCowVersion *)malloc(sizeof(struct HashCowVersion) +
+                                              sizeof(struct HashCowChunk *) * chunkCount);
+    if (version == NULL) {
+        return false;
+    }
+
+    version->refs = 1;
+    version->bktSize = chunkCount * HASH_COW_FANOUT;
+    version->size = 0;
+    version->chunkCount = chunkCount;
+    for (i = 0; i < chunkCount; i++) {
+        version->chunks[i] = NULL;
+    }
+    table->version = version;
+    table->pins = 0;
+    table->writing = false;
+
+    return true;
+}
+
+/**
+ * @brief 开始写操作：挡住新的取快照操作，并等待正在取快照的读线程完成（只需几条指令）
+ * @param table 指向 HashCowTable 的指针
+ */
+static void HashCowWriteBegin(struct HashCowTable *table)
+{
+    /* 与 HashCowSnapshot 中先增加 pins 再检查 writing 的顺序配对，两者至少有一方看到对方 */
+    __atomic_store_n(&table->writing, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&table->pins, __ATOMIC_SEQ_CST) != 0) {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief 结束写操作，此后取得的快照可以看到本次修改
+ * @param table 指向 HashCowTable 的指针
+ */
+static void HashCowWriteEnd(struct HashCowTable *table)
+{
+    __atomic_store_n(&table->writing, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 获取写线程独占的当前版本，当前版本被快照共享时先复制桶目录
+ * @param table 指向 HashCowTable 的指针
+ * @return 独占的版本指针，失败时返回 NULL
+ */
+static struct HashCowVersion *HashCowOwnVersion(struct HashCowTable *table)
+{
+    struct HashCowVersion *version = table->version;
+    struct HashCowVersion *copy = NULL;
+    int i = 0;
+
+    if (__atomic_load_n(&version->refs, __ATOMIC_ACQUIRE) == 1) {
+        return version;
+    }
+
+    copy = (struct HashCowVersion *)malloc(sizeof(struct HashCowVersion) +
+                                           sizeof(struct HashCowChunk *) * version->chunkCount);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->refs = 1;
+    copy->bktSize = version->bktSize;
+    copy->size = version->size;
+    copy->chunkCount = version->chunkCount;
+    for (i = 0; i < version->chunkCount; i++) {
+        copy->chunks[i] = version->chunks[i];
+        if (copy->chunks[i] != NULL) {
+            __atomic_add_fetch(&copy->chunks[i]->refs, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    /* 写操作期间没有读线程在取快照，旧版本若仍被快照持有则 refs 大于 1，不会在此释放 */
+    __atomic_store_n(&table->version, copy, __ATOMIC_RELEASE);
+    HashCowRelease(version);
+
+    return copy;
+}
+
+/**
+ * @brief 获取版本中独占的桶目录块，块被其他版本共享时先复制
+ * @param version 写线程独占的版本指针
+ * @param index 桶目录块下标
+ * @return 独占的桶目录块指针，失败时返回 NULL
+ */
+static struct HashCowChunk *HashCowOwnChunk(struct HashCowVersion *version, int index)
+{
+    struct HashCowChunk *chunk = version->chunks[index];
+    struct HashCowChunk *copy = NULL;
+    int i = 0;
+
+    if (chunk != NULL && __atomic_load_n(&chunk->refs, __ATOMIC_ACQUIRE) == 1) {
+        return chunk;
+    }
+
+    copy = (struct HashCowChunk *)malloc(sizeof(struct HashCowChunk));
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->refs = 1;
+    for (i = 0; i < HASH_COW_FANOUT; i++) {
+        copy->bkts[i] = chunk == NULL ? NULL : chunk->bkts[i];
+        if (copy->bkts[i] != NULL) {
+            __atomic_add_fetch(&copy->bkts[i]->refs, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    version->chunks[index] = copy;
+    HashCowChunkRelease(chunk);
+
+    return copy;
+}
+
+/**
+ * @brief 在桶中查找键，并判断从桶头到该节点是否都只被当前桶引用
+ * @param head 桶中第一个节点
+ * @param key 键
+ * @param exclusive 保存是否可以原地修改
+ * @return 找到的节点，不存在时返回 NULL
+ */
+static struct HashCowEntry *HashCowFind(struct HashCowEntry *head, int key, bool *exclusive)
+{
+    struct HashCowEntry *entry = head;
+
+    *exclusive = true;
+    while (entry != NULL) {
+        if (__atomic_load_n(&entry->refs, __ATOMIC_ACQUIRE) != 1) {
+            *exclusive = false;
+        }
+        if (entry->key == key) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 路径复制：复制桶头到 target 之间的节点，并用 tail 替换 target
+ * @param slot 桶指针
+ * @param target 被替换的节点
+ * @param tail 替换后接在复制节点之后的链（其引用由本函数接管）
+ * @return true 表示成功，false 表示内存不足（桶保持不变）
+ */
+static bool HashCowRewrite(struct HashCowEntry **slot, struct HashCowEntry *target, struct HashCowEntry *tail)
+{
+    struct HashCowEntry *head = *slot;
+    struct HashCowEntry *newHead = NULL;
+    struct HashCowEntry **link = &newHead;
+    struct HashCowEntry *entry = NULL;
+    struct HashCowEntry *copy = NULL;
+
+    for (entry = head; entry != target; entry = entry->next) {
+        copy = (struct HashCowEntry *)malloc(sizeof(struct HashCowEntry));
+        if (copy == NULL) {
+            *link = NULL;
+            HashCowEntryRelease(newHead);
+            HashCowEntryRelease(tail);
+            return false;
+        }
+
+        copy->refs = 1;
+        copy->key = entry->key;
+        copy->val = entry->val;
+        *link = copy;
+        link = &copy->next;
+    }
+
+    *link = tail;
+    *slot = newHead;
+    HashCowEntryRelease(head);
+
+    return true;
+}
+
+/**
+ * @brief 获取键在写时复制 HashTable 中的桶下标
+ * @param version 版本指针
+ * @param key 键
+ * @return 桶下标
+ */
+static int HashCowPosition(struct HashCowVersion *version, int key)
+{
+    return (int)((unsigned int)key % (unsigned int)version->bktSize);
+}
+
+/**
+ * @brief 在写操作中添加键值对（若键已存在，则更新值）
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @param val 值
+ * @return true 表示成功，false 表示失败
+ */
+static bool HashCowWritePut(struct HashCowTable *table, int key, int val)
+{
+    struct HashCowVersion *version = NULL;
+    struct HashCowChunk *chunk = NULL;
+    struct HashCowEntry **slot = NULL;
+    struct HashCowEntry *entry = NULL;
+    struct HashCowEntry *newEntry = NULL;
+    bool exclusive = false;
+    int position = 0;
+
+    version = HashCowOwnVersion(table);
+    if (version == NULL) {
+        return false;
+    }
+
+    position = HashCowPosition(version, key);
+    chunk = HashCowOwnChunk(version, position / HASH_COW_FANOUT);
+    if (chunk == NULL) {
         return false;
     }
-    hashNode->key = key;
-    hashNode->val = val;
 
-    ListAddTail(&hashTable->bkts[position], &hashNode->node);
+    slot = &chunk->bkts[position % HASH_COW_FANOUT];
+    entry = HashCowFind(*slot, key, &exclusive);
+    if (entry != NULL && exclusive) {
+        entry->val = val;
+        return true;
+    }
+
+    newEntry = (struct HashCowEntry *)malloc(sizeof(struct HashCowEntry));
+    if (newEntry == NULL) {
+        return false;
+    }
+    newEntry->refs = 1;
+    newEntry->key = key;
+    newEntry->val = val;
+
+    if (entry == NULL) {
+        /* 新键插在桶头，原有链整体共享，无需复制 */
+        newEntry->next = *slot;
+        *slot = newEntry;
+        version->size++;
+        return true;
+    }
+
+    newEntry->next = entry->next;
+    if (newEntry->next != NULL) {
+        __atomic_add_fetch(&newEntry->next->refs, 1, __ATOMIC_RELAXED);
+    }
+
+    return HashCowRewrite(slot, entry, newEntry);
+}
+
+/**
+ * @brief 向写时复制 HashTable 中添加键值对（若键已存在，则更新值），只能由一个写线程调用
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @param val 值
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowPut(struct HashCowTable *table, int key, int val)
+{
+    bool ok = false;
+
+    if (table == NULL || table->version == NULL) {
+        return false;
+    }
+
+    HashCowWriteBegin(table);
+    ok = HashCowWritePut(table, key, val);
+    HashCowWriteEnd(table);
+
+    return ok;
+}
+
+/**
+ * @brief 在写时复制 HashTable 当前版本中根据键获取对应值（可在任意线程中调用）
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @param saveVal 将获取到的值赋于该参数
+ * @return true 表示成功，false 表示失败
+ */
+bool HashCowGet(struct HashCowTable *table, int key, int *saveVal)
+{
+    struct HashCowVersion *version = NULL;
+    bool found = false;
+
+    version = HashCowSnapshot(table);
+    if (version == NULL) {
+        return false;
+    }
+
+    found = HashCowVersionGet(version, key, saveVal);
+    HashCowRelease(version);
+
+    return found;
+}
+
+/**
+ * @brief 在写操作中删除对应键值对
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @return true 表示成功（含键不存在），false 表示内存不足
+ */
+static bool HashCowWriteRemove(struct HashCowTable *table, int key)
+{
+    struct HashCowVersion *version = NULL;
+    struct HashCowChunk *chunk = NULL;
+    struct HashCowEntry **slot = NULL;
+    struct HashCowEntry **link = NULL;
+    struct HashCowEntry *entry = NULL;
+    bool exclusive = false;
+    int position = 0;
+    int val = 0;
+
+    /* 键不存在时不必复制任何桶目录 */
+    if (!HashCowVersionGet(table->version, key, &val)) {
+        return true;
+    }
+
+    version = HashCowOwnVersion(table);
+    if (version == NULL) {
+        return false;
+    }
+
+    position = HashCowPosition(version, key);
+    chunk = HashCowOwnChunk(version, position / HASH_COW_FANOUT);
+    if (chunk == NULL) {
+        return false;
+    }
+
+    slot = &chunk->bkts[position % HASH_COW_FANOUT];
+    entry = HashCowFind(*slot, key, &exclusive);
+    if (exclusive) {
+        for (link = slot; *link != entry; link = &(*link)->next) {
+        }
+        *link = entry->next;
+        free(entry);
+        version->size--;
+        return true;
+    }
+
+    if (entry->next != NULL) {
+        __atomic_add_fetch(&entry->next->refs, 1, __ATOMIC_RELAXED);
+    }
+    if (!HashCowRewrite(slot, entry, entry->next)) {
+        return false;
+    }
+    version->size--;
 
     return true;
 }
 
 /**
- * @brief 在 HashTable 中根据键获取对应值
- * @param hashTable 指向 HashTable 的指针
+ * @brief 删除写时复制 HashTable 中对应键值对，只能由一个写线程调用
+ * @param table 指向 HashCowTable 的指针
+ * @param key 键
+ * @return true 表示成功（含键不存在），false 表示内存不足
+ */
+bool HashCowRemove(struct HashCowTable *table, int key)
+{
+    bool ok = false;
+
+    if (table == NULL || table->version == NULL) {
+        return false;
+    }
+
+    HashCowWriteBegin(table);
+    ok = HashCowWriteRemove(table, key);
+    HashCowWriteEnd(table);
+
+    return ok;
+}
+
+/**
+ * @brief O(1) 创建当前版本的快照，可在任意线程中调用（写操作进行中时短暂等待其完成）
+ * @param table 指向 HashCowTable 的指针
+ * @return 快照版本指针，之后的读取完全无锁，用完后调用 HashCowRelease
+ */
+struct HashCowVersion *HashCowSnapshot(struct HashCowTable *table)
+{
+    struct HashCowVersion *version = NULL;
+
+    if (table == NULL) {
+        return NULL;
+    }
+
+    while (true) {
+        __atomic_add_fetch(&table->pins, 1, __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&table->writing, __ATOMIC_SEQ_CST)) {
+            break;
+        }
+        /* 写操作可能正在原地修改当前版本，退出后等待其结束 */
+        __atomic_sub_fetch(&table->pins, 1, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&table->writing, __ATOMIC_ACQUIRE)) {
+            sched_yield();
+        }
+    }
+
+    /* pins 不为 0 时写线程不会开始修改，也不会释放当前版本 */
+    version = __atomic_load_n(&table->version, __ATOMIC_ACQUIRE);
+    if (version != NULL) {
+        __atomic_add_fetch(&version->refs, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_sub_fetch(&table->pins, 1, __ATOMIC_RELEASE);
+
+    return version;
+}
+
+/**
+ * @brief 在快照版本中根据键获取对应值（无锁，可在任意线程中调用）
+ * @param version 快照版本指针
  * @param key 键
  * @param saveVal 将获取到的值赋于该参数
  * @return true 表示成功，false 表示失败
- */ 
-bool HashGet(struct HashTable *hashTable, int key, int *saveVal)
+ */
+bool HashCowVersionGet(struct HashCowVersion *version, int key, int *saveVal)
 {
+    struct HashCowChunk *chunk = NULL;
+    struct HashCowEntry *entry = NULL;
     int position = 0;
-    struct HashNode *hashNode = NULL;
-    if (hashTable == NULL || hashTable->bkts == NULL) {
+
+    if (version == NULL) {
         return false;
     }
 
-    position = HashPositionFunc(hashTable, key);
-    if (ListIsEmpty(&hashTable->bkts[position])) {
+    position = HashCowPosition(version, key);
+    chunk = version->chunks[position / HASH_COW_FANOUT];
+    if (chunk == NULL) {
         return false;
     }
 
-    LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[position], struct HashNode, node) {
-        if (hashNode->key == key) {
-            *saveVal = hashNode->val;
+    for (entry = chunk->bkts[position % HASH_COW_FANOUT]; entry != NULL; entry = entry->next) {
+        if (entry->key == key) {
+            *saveVal = entry->val;
             return true;
         }
     }
@@ -324,51 +3052,309 @@ bool HashGet(struct HashTable *hashTable, int key, int *saveVal)
 }
 
 /**
- * @brief 删除 HashTable 中对应键值对
- * @param hashTable 指向 HashTable 的指针
- * @param key 键
- */ 
-void HashRemove(struct HashTable *hashTable, int key)
+ * @brief 释放快照版本，最后一个引用释放时回收不再被共享的桶和节点
+ * @param version 快照版本指针
+ */
+void HashCowRelease(struct HashCowVersion *version)
 {
-    int position = 0;
-    struct HashNode *hashNode = NULL;
-    struct Node *prev = NULL;
-    struct Node *next = NULL;
-    if (hashTable == NULL || hashTable->bkts == NULL) {
+    int i = 0;
+
+    if (version == NULL || __atomic_sub_fetch(&version->refs, 1, __ATOMIC_ACQ_REL) != 0) {
         return;
     }
 
-    position = HashPositionFunc(hashTable, key);
-    if (ListIsEmpty(&hashTable->bkts[position])) {
+    for (i = 0; i < version->chunkCount; i++) {
+        HashCowChunkRelease(version->chunks[i]);
+    }
+    free(version);
+}
+
+/**
+ * @brief 释放写时复制 HashTable（已取得的快照仍然有效）
+ * @param table 指向 HashCowTable 的指针
+ */
+void HashCowFree(struct HashCowTable *table)
+{
+    if (table == NULL) {
         return;
     }
 
-    LIST_FOR_EACH_ENTRY(hashNode, &hashTable->bkts[position], struct HashNode, node) {
-        if (hashNode->key == key) {
-            prev = hashNode->node.prev;
-            next = hashNode->node.next;
-            prev->next = next;
-            next->prev = prev;
-            free(hashNode);
-            return;
+    HashCowRelease(table->version);
+    __atomic_store_n(&table->version, NULL, __ATOMIC_RELEASE);
+}
+
+#ifdef HASH_TRACE
+static const char *hashTraceOpNames[HASH_TRACE_OP_COUNT] = {
+    "HashPut", "HashGet", "HashRemove", "HashFree"
+};
+
+static struct HashTraceThread *hashTraceThreads = NULL;
+static __thread struct HashTraceThread *hashTraceSelf = NULL;
+static pthread_once_t hashTraceKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t hashTraceKey;
+
+/**
+ * @brief 获取当前时间戳（默认单位为纳秒，定义 HASH_TRACE_RDTSC 时为 CPU 周期）
+ * @return 时间戳
+ */
+unsigned long long HashTraceNow(void)
+{
+#if defined(HASH_TRACE_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief 将耗时映射到直方图档位（对数分段，每段线性细分）
+ * @param value 耗时
+ * @return 档位下标
+ */
+static int HashTraceBucket(unsigned long long value)
+{
+    int shift = 0;
+
+    if (value < HASH_TRACE_SUB_COUNT) {
+        return (int)value;
+    }
+
+    shift = 63 - __builtin_clzll(value) - HASH_TRACE_SUB_BITS;
+    return (shift + 1) * HASH_TRACE_SUB_COUNT + (int)((value >> shift) & (HASH_TRACE_SUB_COUNT - 1));
+}
+
+/**
+ * @brief 获取直方图档位所表示的耗时上界
+ * @param bucket 档位下标
+ * @return 耗时上界
+ */
+static unsigned long long HashTraceBucketValue(int bucket)
+{
+    int shift = 0;
+    unsigned long long sub = 0;
+
+    if (bucket < HASH_TRACE_SUB_COUNT) {
+        return (unsigned long long)bucket;
+    }
+
+    shift = bucket / HASH_TRACE_SUB_COUNT - 1;
+    sub = (unsigned long long)(bucket % HASH_TRACE_SUB_COUNT);
+    return ((HASH_TRACE_SUB_COUNT + sub + 1) << shift) - 1;
+}
+
+/**
+ * @brief 线程退出时的回调，释放直方图的所有权供新线程复用
+ * @param arg 直方图指针
+ */
+static void HashTraceThreadExit(void *arg)
+{
+    struct HashTraceThread *self = (struct HashTraceThread *)arg;
+
+    __atomic_store_n(&self->used, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 创建用于在线程退出时归还直方图的线程私有键
+ */
+static void HashTraceKeyCreate(void)
+{
+    pthread_key_create(&hashTraceKey, HashTraceThreadExit);
+}
+
+/**
+ * @brief 获取当前线程的直方图，优先复用空闲直方图，否则创建并注册
+ * @return 直方图指针，内存不足时返回 NULL
+ */
+static struct HashTraceThread *HashTraceThreadGet(void)
+{
+    struct HashTraceThread *self = hashTraceSelf;
+    bool expected = false;
+
+    if (self != NULL) {
+        return self;
+    }
+
+    pthread_once(&hashTraceKeyOnce, HashTraceKeyCreate);
+
+    /* 优先复用已退出线程留下的直方图，全局链表长度不超过同时存活的线程数 */
+    self = __atomic_load_n(&hashTraceThreads, __ATOMIC_ACQUIRE);
+    while (self != NULL) {
+        expected = false;
+        if (__atomic_compare_exchange_n(&self->used, &expected, true, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+        self = self->next;
+    }
+
+    if (self == NULL) {
+        self = (struct HashTraceThread *)calloc(1, sizeof(struct HashTraceThread));
+        if (self == NULL) {
+            return NULL;
+        }
+        self->used = true;
+
+        self->next = __atomic_load_n(&hashTraceThreads, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&hashTraceThreads, &self->next, self, true,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
         }
     }
+
+    pthread_setspecific(hashTraceKey, self);
+    hashTraceSelf = self;
+    return self;
 }
 
 /**
- * @brief 释放 HashTable
- * @param hashTable 指向 HashTable 的指针
- */ 
-void HashFree(struct HashTable *hashTable)
+ * @brief 计时范围结束时的回调，将耗时记入当前线程的直方图
+ * @param scope 计时范围指针
+ */
+void HashTraceScopeEnd(struct HashTraceScope *scope)
+{
+    struct HashTraceThread *self = HashTraceThreadGet();
+    unsigned long long elapsed = HashTraceNow() - scope->start;
+    unsigned long long *count = NULL;
+
+    if (self == NULL) {
+        return;
+    }
+
+    /* 只有所属线程写入，使用普通存储即可，无需原子读-改-写 */
+    count = &self->counts[scope->op][HashTraceBucket(elapsed)];
+    __atomic_store_n(count, *count + 1, __ATOMIC_RELAXED);
+    if (elapsed > self->max[scope->op]) {
+        __atomic_store_n(&self->max[scope->op], elapsed, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief 汇总所有线程的直方图，获取指定操作的延迟分位数
+ * @param op 操作类型
+ * @param percentile 分位数（0 ~ 100，例如 99.9）
+ * @return 延迟上界，没有样本时返回 0
+ */
+unsigned long long HashTracePercentile(enum HashTraceOp op, double percentile)
 {
+    unsigned long long merged[HASH_TRACE_BUCKETS];
+    struct HashTraceThread *thread = NULL;
+    unsigned long long total = 0;
+    unsigned long long target = 0;
+    unsigned long long seen = 0;
+    unsigned long long max = 0;
+    unsigned long long value = 0;
     int i = 0;
-    if (hashTable == NULL || hashTable->bkts == NULL) {
+
+    if (op < 0 || op >= HASH_TRACE_OP_COUNT) {
+        return 0;
+    }
+
+    for (i = 0; i < HASH_TRACE_BUCKETS; i++) {
+        merged[i] = 0;
+    }
+
+    thread = __atomic_load_n(&hashTraceThreads, __ATOMIC_ACQUIRE);
+    while (thread != NULL) {
+        for (i = 0; i < HASH_TRACE_BUCKETS; i++) {
+            merged[i] += __atomic_load_n(&thread->counts[op][i], __ATOMIC_RELAXED);
+        }
+        value = __atomic_load_n(&thread->max[op], __ATOMIC_RELAXED);
+        if (value > max) {
+            max = value;
+        }
+        thread = thread->next;
+    }
+
+    for (i = 0; i < HASH_TRACE_BUCKETS; i++) {
+        total += merged[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    target = (unsigned long long)(total * percentile / 100.0);
+    if (target == 0) {
+        target = 1;
+    }
+
+    /* 档位上界不会超过实际观测到的最大值 */
+    for (i = 0; i < HASH_TRACE_BUCKETS; i++) {
+        seen += merged[i];
+        if (seen >= target) {
+            value = HashTraceBucketValue(i);
+            return value < max ? value : max;
+        }
+    }
+
+    return max;
+}
+
+/**
+ * @brief 输出每种操作的样本数及 p50/p99/p999/max 延迟
+ * @param fp 输出文件指针
+ */
+void HashTraceDump(FILE *fp)
+{
+    struct HashTraceThread *thread = NULL;
+    unsigned long long count = 0;
+    unsigned long long max = 0;
+    unsigned long long value = 0;
+    int op = 0;
+    int i = 0;
+
+    if (fp == NULL) {
         return;
     }
 
-    for (i = 0; i < hashTable->bktSize; i++) {
-        ListFree(&hashTable->bkts[i], HashNodeFreeFunc);
+    fprintf(fp, "%-20s %12s %12s %12s %12s %12s\n", "op", "count", "p50", "p99", "p999", "max");
+    for (op = 0; op < HASH_TRACE_OP_COUNT; op++) {
+        count = 0;
+        max = 0;
+        thread = __atomic_load_n(&hashTraceThreads, __ATOMIC_ACQUIRE);
+        while (thread != NULL) {
+            for (i = 0; i < HASH_TRACE_BUCKETS; i++) {
+                count += __atomic_load_n(&thread->counts[op][i], __ATOMIC_RELAXED);
+            }
+            value = __atomic_load_n(&thread->max[op], __ATOMIC_RELAXED);
+            if (value > max) {
+                max = value;
+            }
+            thread = thread->next;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        fprintf(fp, "%-20s %12llu %12llu %12llu %12llu %12llu\n", hashTraceOpNames[op], count,
+                HashTracePercentile((enum HashTraceOp)op, 50.0),
+                HashTracePercentile((enum HashTraceOp)op, 99.0),
+                HashTracePercentile((enum HashTraceOp)op, 99.9), max);
     }
+}
 
-    free(hashTable->bkts);
-}
\ No newline at end of file
+/**
+ * @brief 清空所有线程的直方图（其他线程同时在记录时结果是近似的：
+ *        所属线程以普通的读-加一-写更新计数，与这里的清零之间没有同步）
+ */
+void HashTraceReset(void)
+{
+    struct HashTraceThread *thread = NULL;
+    int op = 0;
+    int i = 0;
+
+    thread = __atomic_load_n(&hashTraceThreads, __ATOMIC_ACQUIRE);
+    while (thread != NULL) {
+        for (op = 0; op < HASH_TRACE_OP_COUNT; op++) {
+            for (i = 0; i < HASH_TRACE_BUCKETS; i++) {
+                __atomic_store_n(&thread->counts[op][i], 0, __ATOMIC_RELAXED);
+            }
+            __atomic_store_n(&thread->max[op], 0, __ATOMIC_RELAXED);
+        }
+        thread = thread->next;
+    }
+}
+#endif
@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @brief 根据 Node 指针，获取自定义 Type 指针
+ * @param node 链表节点指针
+ * @param type 自定义的结构体类型
+ * @param member 自定义 Type 中 Node 的名称
+ * @return 自定义 Type 指针
+ */
+#define NODE_ENTRY(node, type, member) \
+    ((type *)((char *)(node) - (size_t)&((type *)0)->member))
+
+/**
+ * @brief 堆中每个节点的子节点个数（4 叉堆，兄弟节点位于相邻内存）
+ */
+#define HEAP_ARITY 4
+
+/**
+ * @brief 堆数组的默认初始容量
+ */
+#define HEAP_DEFAULT_CAPACITY 16
+
+/**
+ * @brief 链表模板定义的 Node 类型
+ */ 
+struct Node
+{
+    struct Node *next, *prev;
+};
+
+/**
+ * @brief 链表模板定义的 List 类型
+ */ 
+struct List
+{
+    struct Node base;
+    int size;
+};
+
+/**
+ * @brief 堆模板定义的 HeapNode 类型，内嵌 Node 以便与 List 互通，
+ *        index 记录节点在堆数组中的下标（不在堆中时为 -1）
+ */
+struct HeapNode
+{
+    struct Node node;
+    int index;
+};
+
+/**
+ * @brief 堆模板定义的 Heap 类型（按 compareFunc 的最小堆）
+ */
+struct Heap
+{
+    struct HeapNode **nodes;
+    int size;
+    int capacity;
+    int (*compareFunc)(struct Node *, struct Node *);
+};
+
+/**
+ * @brief 初始化链表
+ * @param list 指向 List 的指针
+ */
+void ListInit(struct List *list);
+
+/**
+ * @brief 堆初始化
+ * @param heap 指向 Heap 的指针
+ * @param capacity 初始容量，小于等于 0 时使用默认容量
+ * @param compareFunc 比较函数，返回值小于 0 的节点优先出堆
+ * @return true 表示成功，false 表示失败
+ */
+bool HeapInit(struct Heap *heap, int capacity, int (*compareFunc)(struct Node *, struct Node *));
+
+/**
+ * @brief 向堆中添加节点
+ * @param heap 指向 Heap 的指针
+ * @param newNode 新节点指针
+ * @return true 表示成功，false 表示失败
+ */
+bool HeapPush(struct Heap *heap, struct HeapNode *newNode);
+
+/**
+ * @brief 获得堆顶（最小）节点
+ * @param heap 指向 Heap 的指针
+ * @return 堆顶节点指针，堆为空时返回 NULL
+ */
+struct HeapNode *HeapPeek(struct Heap *heap);
+
+/**
+ * @brief 取出堆顶（最小）节点
+ * @param heap 指向 Heap 的指针
+ * @return 堆顶节点指针，堆为空时返回 NULL
+ */
+struct HeapNode *HeapPop(struct Heap *heap);
+
+/**
+ * @brief 节点的键变小后调整其在堆中的位置
+ * @param heap 指向 Heap 的指针
+ * @param node 键已被调小的节点指针
+ */
+void HeapDecreaseKey(struct Heap *heap, struct HeapNode *node);
+
+/**
+ * @brief 从堆中移除任意节点（不释放节点空间）
+ * @param heap 指向 Heap 的指针
+ * @param node 待移除节点指针
+ */
+void HeapRemove(struct Heap *heap, struct HeapNode *node);
+
+/**
+ * @brief 将链表中所有节点批量建堆，链表随后被置空
+ * @param heap 指向 Heap 的指针
+ * @param list 指向 List 的指针，其节点须为 HeapNode 中的 node 成员
+ * @return true 表示成功，false 表示失败（链表保持不变）
+ */
+bool HeapFromList(struct Heap *heap, struct List *list);
+
+/**
+ * @brief 判断堆是否为空
+ * @param heap 指向 Heap 的指针
+ * @return true 表示为空，false 非空
+ */
+bool HeapIsEmpty(struct Heap *heap);
+
+/**
+ * @brief 释放堆
+ * @param heap 指向 Heap 的指针
+ * @param freeFunc 释放实际节点空间的函数指针，为 NULL 时只释放堆数组
+ */
+void HeapFree(struct Heap *heap, void (*freeFunc)(struct Node *));
+
+/**
+ * @brief 初始化链表
+ * @param list 指向 List 的指针
+ */
+void ListInit(struct List *list)
+{
+    if (list == NULL) {
+        return;
+    }
+
+    list->base.next = &list->base;
+    list->base.prev = &list->base;
+    list->size = 0;
+}
+
+/**
+ * @brief 堆初始化
+ * @param heap 指向 Heap 的指针
+ * @param capacity 初始容量，小于等于 0 时使用默认容量
+ * @param compareFunc 比较函数，返回值小于 0 的节点优先出堆
+ * @return true 表示成功，false 表示失败
+ */
+bool HeapInit(struct Heap *heap, int capacity, int (*compareFunc)(struct Node *, struct Node *))
+{
+    if (heap == NULL || compareFunc == NULL) {
+        return false;
+    }
+
+    if (capacity <= 0) {
+        capacity = HEAP_DEFAULT_CAPACITY;
+    }
+
+    heap->nodes = (struct HeapNode **)malloc(sizeof(struct HeapNode *) * capacity);
+    if (heap->nodes == NULL) {
+        return false;
+    }
+
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->compareFunc = compareFunc;
+
+    return true;
+}
+
+/**
+ * @brief 保证堆数组至少能容纳 capacity 个节点
+ * @param heap 指向 Heap 的指针
+ * @param capacity 所需容量
+ * @return true 表示成功，false 表示失败
+ */
+static bool HeapReserve(struct Heap *heap, int capacity)
+{
+    struct HeapNode **nodes = NULL;
+    int newCapacity = heap->capacity;
+
+    if (capacity <= heap->capacity) {
+        return true;
+    }
+
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+
+    nodes = (struct HeapNode **)realloc(heap->nodes, sizeof(struct HeapNode *) * newCapacity);
+    if (nodes == NULL) {
+        return false;
+    }
+
+    heap->nodes = nodes;
+    heap->capacity = newCapacity;
+
+    return true;
+}
+
+/**
+ * @brief 将下标 index 处的节点向上调整
+ * @param heap 指向 Heap 的指针
+ * @param index 节点下标
+ */
+static void HeapSiftUp(struct Heap *heap, int index)
+{
+    struct HeapNode *node = heap->nodes[index];
+    int parent = 0;
+
+    while (index > 0) {
+        parent = (index - 1) / HEAP_ARITY;
+        if (heap->compareFunc(&node->node, &heap->nodes[parent]->node) >= 0) {
+            break;
+        }
+
+        heap->nodes[index] = heap->nodes[parent];
+        heap->nodes[index]->index = index;
+        index = parent;
+    }
+
+    heap->nodes[index] = node;
+    node->index = index;
+}
+
+/**
+ * @brief 将下标 index 处的节点向下调整
+ * @param heap 指向 Heap 的指针
+ * @param index 节点下标
+ */
+static void HeapSiftDown(struct Heap *heap, int index)
+{
+    struct HeapNode *node = heap->nodes[index];
+    int child = 0;
+    int last = 0;
+    int min = 0;
+
+    while (true) {
+        child = index * HEAP_ARITY + 1;
+        if (child >= heap->size) {
+            break;
+        }
+
+        last = child + HEAP_ARITY;
+        if (last > heap->size) {
+            last = heap->size;
+        }
+
+        min = child;
+        for (child = child + 1; child < last; child++) {
+            if (heap->compareFunc(&heap->nodes[child]->node, &heap->nodes[min]->node) < 0) {
+                min = child;
+            }
+        }
+
+        if (heap->compareFunc(&heap->nodes[min]->node, &node->node) >= 0) {
+            break;
+        }
+
+        heap->nodes[index] = heap->nodes[min];
+        heap->nodes[index]->index = index;
+        index = min;
+    }
+
+    heap->nodes[index] = node;
+    node->index = index;
+}
+
+/**
+ * @brief 向堆中添加节点
+ * @param heap 指向 Heap 的指针
+ * @param newNode 新节点指针
+ * @return true 表示成功，false 表示失败
+ */
+bool HeapPush(struct Heap *heap, struct HeapNode *newNode)
+{
+    if (heap == NULL || heap->nodes == NULL || newNode == NULL) {
+        return false;
+    }
+
+    if (!HeapReserve(heap, heap->size + 1)) {
+        return false;
+    }
+
+    heap->nodes[heap->size] = newNode;
+    heap->size++;
+    HeapSiftUp(heap, heap->size - 1);
+
+    return true;
+}
+
+/**
+ * @brief 获得堆顶（最小）节点
+ * @param heap 指向 Heap 的指针
+ * @return 堆顶节点指针，堆为空时返回 NULL
+ */
+struct HeapNode *HeapPeek(struct Heap *heap)
+{
+    if (HeapIsEmpty(heap)) {
+        return NULL;
+    }
+
+    return heap->nodes[0];
+}
+
+/**
+ * @brief 取出堆顶（最小）节点
+ * @param heap 指向 Heap 的指针
+ * @return 堆顶节点指针，堆为空时返回 NULL
+ */
+struct HeapNode *HeapPop(struct Heap *heap)
+{
+    struct HeapNode *top = NULL;
+
+    if (HeapIsEmpty(heap)) {
+        return NULL;
+    }
+
+    top = heap->nodes[0];
+    HeapRemove(heap, top);
+
+    return top;
+}
+
+/**
+ * @brief 节点的键变小后调整其在堆中的位置
+ * @param heap 指向 Heap 的指针
+ * @param node 键已被调小的节点指针
+ */
+void HeapDecreaseKey(struct Heap *heap, struct HeapNode *node)
+{
+    if (heap == NULL || node == NULL || node->index < 0 || node->index >= heap->size ||
+        heap->nodes[node->index] != node) {
+        return;
+    }
+
+    HeapSiftUp(heap, node->index);
+}
+
+/**
+ * @brief 从堆中移除任意节点（不释放节点空间）
+ * @param heap 指向 Heap 的指针
+ * @param node 待移除节点指针
+ */
+void HeapRemove(struct Heap *heap, struct HeapNode *node)
+{
+    struct HeapNode *moved = NULL;
+    int index = 0;
+
+    if (heap == NULL || node == NULL || node->index < 0 || node->index >= heap->size ||
+        heap->nodes[node->index] != node) {
+        return;
+    }
+
+    index = node->index;
+    heap->size--;
+    node->index = -1;
+    if (index == heap->size) {
+        return;
+    }
+
+    moved = heap->nodes[heap->size];
+    heap->nodes[index] = moved;
+    HeapSiftDown(heap, index);
+    if (moved->index == index) {
+        HeapSiftUp(heap, index);
+    }
+}
+
+/**
+ * @brief 将链表中所有节点批量建堆，链表随后被置空
+ * @param heap 指向 Heap 的指针
+ * @param list 指向 List 的指针，其节点须为 HeapNode 中的 node 成员
+ * @return true 表示成功，false 表示失败（链表保持不变）
+ */
+bool HeapFromList(struct Heap *heap, struct List *list)
+{
+    struct Node *node = NULL;
+    int i = 0;
+
+    if (heap == NULL || heap->nodes == NULL || list == NULL) {
+        return false;
+    }
+
+    if (!HeapReserve(heap, heap->size + list->size)) {
+        return false;
+    }
+
+    node = list->base.next;
+    while (node != &list->base) {
+        heap->nodes[heap->size] = NODE_ENTRY(node, struct HeapNode, node);
+        heap->nodes[heap->size]->index = heap->size;
+        heap->size++;
+        node = node->next;
+    }
+
+    ListInit(list);
+
+    if (heap->size < 2) {
+        return true;
+    }
+
+    /* 自底向上建堆，整体 O(n) */
+    for (i = (heap->size - 2) / HEAP_ARITY; i >= 0; i--) {
+        HeapSiftDown(heap, i);
+    }
+
+    return true;
+}
+
+/**
+ * @brief 判断堆是否为空
+ * @param heap 指向 Heap 的指针
+ * @return true 表示为空，false 非空
+ */
+bool HeapIsEmpty(struct Heap *heap)
+{
+    if (heap == NULL || heap->nodes == NULL || heap->size == 0) {
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief 释放堆
+ * @param heap 指向 Heap 的指针
+ * @param freeFunc 释放实际节点空间的函数指针，为 NULL 时只释放堆数组
+ */
+void HeapFree(struct Heap *heap, void (*freeFunc)(struct Node *))
+{
+    int i = 0;
+
+    if (heap == NULL || heap->nodes == NULL) {
+        return;
+    }
+
+    if (freeFunc != NULL) {
+        for (i = 0; i < heap->size; i++) {
+            freeFunc(&heap->nodes[i]->node);
+        }
+    }
+
+    free(heap->nodes);
+    heap->nodes = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+}
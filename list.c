@@ -1,7 +1,16 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <malloc.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#ifdef LIST_TRACE
+#include <time.h>
+#endif
 
 /**
  * @brief 根据 Node 指针，获取自定义 Type 指针
@@ -25,6 +34,39 @@
          &(entry)->member != &(list)->base; \
          entry = NODE_ENTRY((entry)->member.next, type, member))
 
+/**
+ * @brief 在读侧临界区内遍历循环链表，可与 ListEpoch 系列写操作并发执行
+ *        （只沿 next 方向遍历，需位于 ListEpochReadLock / ListEpochReadUnlock 之间）
+ * @param entry 自定义 Type 指针，用来存放数据
+ * @param list List 指针
+ * @param type 自定义的结构体类型
+ * @param member 自定义 Type 中 Node 的名称
+ */
+#define LIST_FOR_EACH_ENTRY_EPOCH(entry, list, type, member) \
+    for (entry = NODE_ENTRY(__atomic_load_n(&(list)->base.next, __ATOMIC_ACQUIRE), type, member); \
+         &(entry)->member != &(list)->base; \
+         entry = NODE_ENTRY(__atomic_load_n(&(entry)->member.next, __ATOMIC_ACQUIRE), type, member))
+
+/**
+ * @brief 获取自定义 Type 中整数键相对于 Node 成员的偏移，供 ListSortByKey 使用
+ * @param type 自定义的结构体类型
+ * @param member 自定义 Type 中 Node 的名称
+ * @param key 自定义 Type 中整数键的名称
+ * @return 键相对于 Node 成员的字节偏移（可为负）
+ */
+#define LIST_KEY_OFFSET(type, member, key) \
+    ((long)((size_t)&((type *)0)->key) - (long)((size_t)&((type *)0)->member))
+
+/**
+ * @brief ListEpoch 可同时注册的读线程个数上限
+ */
+#define LIST_EPOCH_MAX_READERS 64
+
+/**
+ * @brief 待回收节点数超过该值时，写操作会顺带尝试推进一次纪元
+ */
+#define LIST_EPOCH_RECLAIM_THRESHOLD 64
+
 /**
  * @brief 链表模板定义的 Node 类型
  */ 
@@ -42,6 +84,203 @@ struct List
     int size;
 };
 
+/**
+ * @brief ListEpoch 读线程槽位，独占一个缓存行避免读线程之间伪共享
+ *        state 为 0 表示不在临界区内，否则为 (进入时的纪元 << 1) | 1
+ */
+struct ListEpochReader
+{
+    unsigned long state;
+    bool used;
+} __attribute__((aligned(64)));
+
+/**
+ * @brief 基于纪元的延迟回收域（类 RCU），被摘除的节点经由 prev 指针挂到
+ *        对应纪元的待回收链上，经过宽限期后才调用 freeFunc；
+ *        读线程槽位由 ListEpochInit 按缓存行对齐单独分配，ListEpoch 本身可任意分配
+ */
+struct ListEpoch
+{
+    unsigned long epoch;
+    struct Node *limbo[3];
+    int limboSize;
+    void (*freeFunc)(struct Node *);
+    struct ListEpochReader *readers;
+};
+
+/**
+ * @brief 增量释放时每次调用默认释放的节点个数
+ */
+#define LIST_RECLAIM_BUDGET 1024
+
+/**
+ * @brief 待后台释放的链表，节点已整体从原链表摘下
+ */
+struct ListReclaimJob
+{
+    struct List list;
+    void (*freeFunc)(struct Node *);
+    struct ListReclaimJob *next;
+};
+
+/**
+ * @brief 链表延迟释放器，可启动后台线程释放，也可由调用方分批释放
+ */
+struct ListReclaimer
+{
+    struct ListReclaimJob *head;
+    struct ListReclaimJob *tail;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool background;
+    bool stopping;
+};
+
+/**
+ * @brief 外部排序默认内存预算（字节）
+ */
+#define LIST_EXT_SORT_MEMORY (64 * 1024 * 1024)
+
+/**
+ * @brief 外部排序每个有序段读缓冲区及写缓冲区的大小（字节），由排序器自行分配
+ */
+#define LIST_EXT_SORT_IO_BUFFER (256 * 1024)
+
+/**
+ * @brief 外部排序单趟归并的路数上限
+ */
+#define LIST_EXT_SORT_MAX_FAN_IN 512
+
+/**
+ * @brief 外部排序配置
+ *        serializeFunc 将节点写成固定 recordSize 字节的记录，deserializeFunc 由记录重新分配节点；
+ *        nodeSize 为单个节点在内存中占用的字节数，用于按 memoryLimit 切分有序段
+ */
+struct ListExtSortConfig
+{
+    int (*compareFunc)(struct Node *, struct Node *);
+    void (*serializeFunc)(struct Node *, void *);
+    struct Node *(*deserializeFunc)(const void *);
+    void (*freeFunc)(struct Node *);
+    size_t recordSize;
+    size_t nodeSize;
+    size_t memoryLimit;
+    const char *tempDir;
+};
+
+/**
+ * @brief 外部排序临时文件中的一个有序段
+ */
+struct ListExtSortRun
+{
+    unsigned long long offset;
+    unsigned long long count;
+};
+
+/**
+ * @brief 归并时某个有序段的读取状态，buffer 中 [pos, len) 为已读入但尚未取出的记录
+ */
+struct ListExtSortReader
+{
+    unsigned char *buffer;
+    size_t pos;
+    size_t len;
+    unsigned long long offset;
+    unsigned long long left;
+};
+
+/**
+ * @brief 外部（超出内存）流式排序器：内存中攒满一段后排序，追加到同一个临时文件中成为一个有序段；
+ *        结束时若有序段多于 fanIn，则每趟把相邻的 fanIn 段归并成一段写入新文件，
+ *        直到不超过 fanIn 段，最后一趟用败者树流式输出
+ */
+struct ListExtSort
+{
+    struct ListExtSortConfig config;
+    struct List run;
+    int runLimit;
+    int fanIn;
+    size_t bufferBytes;
+    int fd;
+    struct ListExtSortRun *runs;
+    int runCount;
+    int runCapacity;
+    unsigned char *writeBuffer;
+    size_t writeUsed;
+    unsigned long long writeOffset;
+    struct ListExtSortReader *readers;
+    int readFd;
+    int mergeCount;
+    struct Node **heads;
+    int *tree;
+    bool finished;
+    bool error;
+};
+
+/**
+ * @brief 基数排序中的 (键, 节点) 对
+ */
+struct ListKeyPair
+{
+    unsigned long long key;
+    struct Node *node;
+};
+
+/**
+ * @brief 延迟直方图每个数量级内的细分档位位数（4 位约 6% 相对误差）
+ */
+#define LIST_TRACE_SUB_BITS 4
+#define LIST_TRACE_SUB_COUNT (1 << LIST_TRACE_SUB_BITS)
+#define LIST_TRACE_BUCKETS (64 * LIST_TRACE_SUB_COUNT)
+
+/**
+ * @brief 被追踪的操作类型
+ */
+enum ListTraceOp
+{
+    LIST_TRACE_GET,
+    LIST_TRACE_ADD_AT_INDEX,
+    LIST_TRACE_DELETE_AT_INDEX,
+    LIST_TRACE_FREE,
+    LIST_TRACE_SORT,
+    LIST_TRACE_CONTAINS,
+    LIST_TRACE_OP_COUNT
+};
+
+#ifdef LIST_TRACE
+/**
+ * @brief 每个线程独占的 HDR 延迟直方图，只有所属线程写入，
+ *        首次使用时以无锁方式挂到全局链表上供 ListTraceDump 汇总；
+ *        线程退出后 used 置为 false，直方图（连同已记录的样本）交给之后新建的线程复用
+ */
+struct ListTraceThread
+{
+    unsigned long long counts[LIST_TRACE_OP_COUNT][LIST_TRACE_BUCKETS];
+    unsigned long long max[LIST_TRACE_OP_COUNT];
+    struct ListTraceThread *next;
+    bool used;
+};
+
+/**
+ * @brief 单次 API 调用的计时范围，离开作用域时自动记录耗时
+ */
+struct ListTraceScope
+{
+    enum ListTraceOp op;
+    unsigned long long start;
+};
+
+/**
+ * @brief 记录所在函数从此处到返回的耗时
+ * @param op 操作类型
+ */
+#define LIST_TRACE_SCOPE(op) \
+    struct ListTraceScope listTraceScope __attribute__((cleanup(ListTraceScopeEnd))) = { (op), ListTraceNow() }
+#else
+#define LIST_TRACE_SCOPE(op)
+#endif
+
 /**
  * @brief 初始化链表
  * @param list 指向 List 的指针
@@ -165,6 +404,229 @@ struct Node *ListGetTail(struct List *list);
  */ 
 bool ListContains(struct List *list, struct Node *node, bool (*equalsFunc)(struct Node *, struct Node *));
 
+/**
+ * @brief 初始化纪元回收域
+ * @param epoch 指向 ListEpoch 的指针
+ * @param freeFunc 宽限期结束后释放实际节点空间的函数指针
+ * @return true 表示成功，false 表示失败
+ */
+bool ListEpochInit(struct ListEpoch *epoch, void (*freeFunc)(struct Node *));
+
+/**
+ * @brief 注册读线程，每个读线程调用一次
+ * @param epoch 指向 ListEpoch 的指针
+ * @return 读线程槽位指针，槽位耗尽时返回 NULL
+ */
+struct ListEpochReader *ListEpochRegister(struct ListEpoch *epoch);
+
+/**
+ * @brief 注销读线程
+ * @param reader 读线程槽位指针
+ */
+void ListEpochUnregister(struct ListEpochReader *reader);
+
+/**
+ * @brief 进入读侧临界区（不可嵌套）
+ * @param epoch 指向 ListEpoch 的指针
+ * @param reader 读线程槽位指针
+ */
+void ListEpochReadLock(struct ListEpoch *epoch, struct ListEpochReader *reader);
+
+/**
+ * @brief 退出读侧临界区
+ * @param reader 读线程槽位指针
+ */
+void ListEpochReadUnlock(struct ListEpochReader *reader);
+
+/**
+ * @brief 向链表头部发布节点，读线程可并发遍历
+ * @param list 指向 List 的指针
+ * @param newNode 新节点指针
+ */
+void ListEpochAddHead(struct List *list, struct Node *newNode);
+
+/**
+ * @brief 向链表尾部发布节点，读线程可并发遍历
+ * @param list 指向 List 的指针
+ * @param newNode 新节点指针
+ */
+void ListEpochAddTail(struct List *list, struct Node *newNode);
+
+/**
+ * @brief 摘除链表指定下标节点，宽限期结束后再释放
+ * @param list 指向 List 的指针
+ * @param index 下标
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochDeleteAtIndex(struct List *list, int index, struct ListEpoch *epoch);
+
+/**
+ * @brief 摘除链表头部元素，宽限期结束后再释放
+ * @param list 指向 List 的指针
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochRemoveHead(struct List *list, struct ListEpoch *epoch);
+
+/**
+ * @brief 摘除链表尾部元素，宽限期结束后再释放
+ * @param list 指向 List 的指针
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochRemoveTail(struct List *list, struct ListEpoch *epoch);
+
+/**
+ * @brief 尝试推进纪元并释放已度过宽限期的节点（非阻塞）
+ * @param epoch 指向 ListEpoch 的指针
+ * @return true 表示推进成功，false 表示仍有读线程停留在旧纪元
+ */
+bool ListEpochReclaim(struct ListEpoch *epoch);
+
+/**
+ * @brief 等待宽限期结束，返回时此前摘除的节点均已释放
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochSynchronize(struct ListEpoch *epoch);
+
+/**
+ * @brief 释放回收域中所有待回收节点及读线程槽位（调用时不得有读线程处于临界区）
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochDestroy(struct ListEpoch *epoch);
+
+/**
+ * @brief 初始化链表延迟释放器
+ * @param reclaimer 指向 ListReclaimer 的指针
+ * @param background true 表示启动后台线程释放，false 表示由 ListReclaimStep 分批释放
+ * @return true 表示成功，false 表示失败
+ */
+bool ListReclaimerInit(struct ListReclaimer *reclaimer, bool background);
+
+/**
+ * @brief 异步释放整个链表，O(1) 摘下所有节点后交给释放器，链表随即变为空链表
+ * @param reclaimer 指向 ListReclaimer 的指针
+ * @param list 指向 List 的指针
+ * @param freeFunc 释放实际节点空间的函数指针
+ */
+void ListFreeAsync(struct ListReclaimer *reclaimer, struct List *list, void (*freeFunc)(struct Node *));
+
+/**
+ * @brief 分批释放延迟释放器中的节点
+ * @param reclaimer 指向 ListReclaimer 的指针
+ * @param budget 本次最多释放的节点个数
+ * @return 本次实际释放的节点个数
+ */
+int ListReclaimStep(struct ListReclaimer *reclaimer, int budget);
+
+/**
+ * @brief 停止后台线程并释放所有剩余节点
+ * @param reclaimer 指向 ListReclaimer 的指针
+ */
+void ListReclaimerDestroy(struct ListReclaimer *reclaimer);
+
+/**
+ * @brief 初始化外部排序器
+ * @param sorter 指向 ListExtSort 的指针
+ * @param config 排序配置，memoryLimit 为 0 时使用默认预算，tempDir 为 NULL 时使用 /tmp
+ * @return true 表示成功，false 表示失败
+ */
+bool ListExtSortInit(struct ListExtSort *sorter, const struct ListExtSortConfig *config);
+
+/**
+ * @brief 向外部排序器中添加节点，节点归排序器所有，内存预算用满时写出一个有序段
+ * @param sorter 指向 ListExtSort 的指针
+ * @param node 节点指针
+ * @return true 表示成功，false 表示写临时文件失败
+ */
+bool ListExtSortAdd(struct ListExtSort *sorter, struct Node *node);
+
+/**
+ * @brief 将链表中所有节点移入外部排序器，链表随后被置空
+ * @param sorter 指向 ListExtSort 的指针
+ * @param list 指向 List 的指针
+ * @return true 表示成功，false 表示写临时文件失败
+ */
+bool ListExtSortAddList(struct ListExtSort *sorter, struct List *list);
+
+/**
+ * @brief 结束输入并准备归并输出
+ * @param sorter 指向 ListExtSort 的指针
+ * @return true 表示成功，false 表示失败
+ */
+bool ListExtSortFinish(struct ListExtSort *sorter);
+
+/**
+ * @brief 按序取出下一个节点（流式输出），节点归调用方所有
+ * @param sorter 指向 ListExtSort 的指针
+ * @return 节点指针，全部取完或出错时返回 NULL
+ */
+struct Node *ListExtSortNext(struct ListExtSort *sorter);
+
+/**
+ * @brief 按序取出所有节点并链接到链表尾部
+ * @param sorter 指向 ListExtSort 的指针
+ * @param list 指向 List 的指针
+ * @return true 表示成功，false 表示读取临时文件出错
+ */
+bool ListExtSortToList(struct ListExtSort *sorter, struct List *list);
+
+/**
+ * @brief 释放外部排序器，关闭临时文件并释放尚未取出的节点
+ * @param sorter 指向 ListExtSort 的指针
+ */
+void ListExtSortFree(struct ListExtSort *sorter);
+
+/**
+ * @brief 按节点内嵌的 32/64 位整数键做 LSD 基数排序（稳定，不调用比较函数）
+ * @param list 指向 List 的指针
+ * @param keyOffset 键相对于 Node 的字节偏移，可用 LIST_KEY_OFFSET 获取
+ * @param keySize 键的字节数，4 或 8
+ * @param isSigned 键是否为有符号整数
+ * @return true 表示成功，false 表示参数错误或内存不足（链表保持不变）
+ */
+bool ListSortByKey(struct List *list, long keyOffset, int keySize, bool isSigned);
+
+/**
+ * @brief 按键提取函数返回的无符号 64 位整数键做 LSD 基数排序（稳定，不调用比较函数）
+ * @param list 指向 List 的指针
+ * @param keyFunc 从节点提取键的函数指针
+ * @return true 表示成功，false 表示参数错误或内存不足（链表保持不变）
+ */
+bool ListSortByKeyFunc(struct List *list, unsigned long long (*keyFunc)(struct Node *));
+
+#ifdef LIST_TRACE
+/**
+ * @brief 获取当前时间戳（默认单位为纳秒，定义 LIST_TRACE_RDTSC 时为 CPU 周期）
+ * @return 时间戳
+ */
+unsigned long long ListTraceNow(void);
+
+/**
+ * @brief 计时范围结束时的回调，将耗时记入当前线程的直方图
+ * @param scope 计时范围指针
+ */
+void ListTraceScopeEnd(struct ListTraceScope *scope);
+
+/**
+ * @brief 汇总所有线程的直方图，获取指定操作的延迟分位数
+ * @param op 操作类型
+ * @param percentile 分位数（0 ~ 100，例如 99.9）
+ * @return 延迟上界，没有样本时返回 0
+ */
+unsigned long long ListTracePercentile(enum ListTraceOp op, double percentile);
+
+/**
+ * @brief 输出每种操作的样本数及 p50/p99/p999/max 延迟
+ * @param fp 输出文件指针
+ */
+void ListTraceDump(FILE *fp);
+
+/**
+ * @brief 清空所有线程的直方图（其他线程同时在记录时结果是近似的：
+ *        正在写入的样本可能丢失，也可能把清空前的计数写回）
+ */
+void ListTraceReset(void);
+#endif
+
 /**
  * @brief 初始化链表
  * @param list 指向 List 的指针
@@ -190,6 +652,7 @@ struct Node *ListGet(struct List *list, int index)
 {
     struct Node *node = NULL;
     int pos = 0;
+    LIST_TRACE_SCOPE(LIST_TRACE_GET);
 
     if (list == NULL || index < 0 || index >= list->size) {
         return NULL;
@@ -224,6 +687,7 @@ void ListAddAtIndex(struct List *list, struct Node *newNode, int index)
 {
     struct Node *node = NULL;
     struct Node *prev = NULL;
+    LIST_TRACE_SCOPE(LIST_TRACE_ADD_AT_INDEX);
 
     if (list == NULL || newNode == NULL || index > list->size) {
         return;
@@ -293,6 +757,7 @@ void ListDeleteAtIndex(struct List *list, int index, void (*freeFunc)(struct Nod
 {
     struct Node *node = NULL;
     struct Node *prev = NULL;
+    LIST_TRACE_SCOPE(LIST_TRACE_DELETE_AT_INDEX);
 
     if (list == NULL || freeFunc == NULL || index < 0 || index >= list->size) {
         return;
@@ -319,6 +784,7 @@ void ListDeleteAtIndex(struct List *list, int index, void (*freeFunc)(struct Nod
 void ListFree(struct List *list, void (*freeFunc)(struct Node *))
 {
     struct Node *node = NULL;
+    LIST_TRACE_SCOPE(LIST_TRACE_FREE);
 
     if (list == NULL || freeFunc == NULL) {
         return;
@@ -389,6 +855,7 @@ void ListSort(struct List *list, int (*compareFunc)(struct Node *, struct Node *
     struct Node *ptr = NULL;
     struct Node *ptrNext = NULL;
     struct Node *node = NULL;
+    LIST_TRACE_SCOPE(LIST_TRACE_SORT);
 
     if (list == NULL || compareFunc == NULL || list->size == 0 || list->size == 1) {
         return;
@@ -503,6 +970,7 @@ struct Node *ListGetTail(struct List *list)
 bool ListContains(struct List *list, struct Node *node, bool (*equalsFunc)(struct Node *, struct Node *))
 {
     struct Node *ptr = NULL;
+    LIST_TRACE_SCOPE(LIST_TRACE_CONTAINS);
     if (list == NULL || node == NULL || equalsFunc == NULL || list->size == 0) {
         return false;
     }
@@ -517,4 +985,1622 @@ bool ListContains(struct List *list, struct Node *node, bool (*equalsFunc)(struc
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 初始化纪元回收域
+ * @param epoch 指向 ListEpoch 的指针
+ * @param freeFunc 宽限期结束后释放实际节点空间的函数指针
+ * @return true 表示成功，false 表示失败
+ */
+bool ListEpochInit(struct ListEpoch *epoch, void (*freeFunc)(struct Node *))
+{
+    int i = 0;
+
+    if (epoch == NULL) {
+        return false;
+    }
+
+    /* malloc 只保证 16 字节对齐，槽位须按缓存行对齐分配才能真正独占缓存行 */
+    epoch->readers = (struct ListEpochReader *)aligned_alloc(sizeof(struct ListEpochReader),
+                                                             sizeof(struct ListEpochReader) * LIST_EPOCH_MAX_READERS);
+    if (epoch->readers == NULL) {
+        return false;
+    }
+
+    epoch->epoch = 0;
+    for (i = 0; i < 3; i++) {
+        epoch->limbo[i] = NULL;
+    }
+    epoch->limboSize = 0;
+    epoch->freeFunc = freeFunc;
+    for (i = 0; i < LIST_EPOCH_MAX_READERS; i++) {
+        epoch->readers[i].state = 0;
+        epoch->readers[i].used = false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 注册读线程，每个读线程调用一次
+ * @param epoch 指向 ListEpoch 的指针
+ * @return 读线程槽位指针，槽位耗尽时返回 NULL
+ */
+struct ListEpochReader *ListEpochRegister(struct ListEpoch *epoch)
+{
+    int i = 0;
+    bool expected = false;
+
+    if (epoch == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < LIST_EPOCH_MAX_READERS; i++) {
+        expected = false;
+        if (__atomic_compare_exchange_n(&epoch->readers[i].used, &expected, true, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&epoch->readers[i].state, 0, __ATOMIC_RELAXED);
+            return &epoch->readers[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 注销读线程
+ * @param reader 读线程槽位指针
+ */
+void ListEpochUnregister(struct ListEpochReader *reader)
+{
+    if (reader == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&reader->state, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&reader->used, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 进入读侧临界区（不可嵌套）
+ *        只有普通的加载/存储和一次内存屏障，没有原子读-改-写操作
+ * @param epoch 指向 ListEpoch 的指针
+ * @param reader 读线程槽位指针
+ */
+void ListEpochReadLock(struct ListEpoch *epoch, struct ListEpochReader *reader)
+{
+    unsigned long cur = 0;
+
+    cur = __atomic_load_n(&epoch->epoch, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&reader->state, (cur << 1) | 1UL, __ATOMIC_RELAXED);
+    /* 宣告纪元后再读取链表指针，与 ListEpochReclaim 中的屏障配对 */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 退出读侧临界区
+ * @param reader 读线程槽位指针
+ */
+void ListEpochReadUnlock(struct ListEpochReader *reader)
+{
+    __atomic_store_n(&reader->state, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 向链表头部发布节点，读线程可并发遍历
+ * @param list 指向 List 的指针
+ * @param newNode 新节点指针
+ */
+void ListEpochAddHead(struct List *list, struct Node *newNode)
+{
+    if (list == NULL || newNode == NULL) {
+        return;
+    }
+
+    newNode->prev = &list->base;
+    newNode->next = list->base.next;
+    newNode->next->prev = newNode;
+    __atomic_store_n(&list->base.next, newNode, __ATOMIC_RELEASE);
+    list->size++;
+}
+
+/**
+ * @brief 向链表尾部发布节点，读线程可并发遍历
+ * @param list 指向 List 的指针
+ * @param newNode 新节点指针
+ */
+void ListEpochAddTail(struct List *list, struct Node *newNode)
+{
+    if (list == NULL || newNode == NULL) {
+        return;
+    }
+
+    newNode->prev = list->base.prev;
+    newNode->next = &list->base;
+    __atomic_store_n(&newNode->prev->next, newNode, __ATOMIC_RELEASE);
+    list->base.prev = newNode;
+    list->size++;
+}
+
+/**
+ * @brief 从链表中摘除节点并挂到当前纪元的待回收链上
+ *        节点的 next 保持不变，正在访问该节点的读线程仍能继续向后遍历
+ * @param list 指向 List 的指针
+ * @param node 待摘除节点
+ * @param epoch 指向 ListEpoch 的指针
+ */
+static void ListEpochRetire(struct List *list, struct Node *node, struct ListEpoch *epoch)
+{
+    struct Node *prev = node->prev;
+    unsigned long slot = epoch->epoch % 3;
+
+    __atomic_store_n(&prev->next, node->next, __ATOMIC_RELEASE);
+    node->next->prev = prev;
+    list->size--;
+
+    node->prev = epoch->limbo[slot];
+    epoch->limbo[slot] = node;
+    epoch->limboSize++;
+
+    if (epoch->limboSize >= LIST_EPOCH_RECLAIM_THRESHOLD) {
+        ListEpochReclaim(epoch);
+    }
+}
+
+/**
+ * @brief 摘除链表指定下标节点，宽限期结束后再释放
+ * @param list 指向 List 的指针
+ * @param index 下标
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochDeleteAtIndex(struct List *list, int index, struct ListEpoch *epoch)
+{
+    if (list == NULL || epoch == NULL || index < 0 || index >= list->size) {
+        return;
+    }
+
+    ListEpochRetire(list, ListGet(list, index), epoch);
+}
+
+/**
+ * @brief 摘除链表头部元素，宽限期结束后再释放
+ * @param list 指向 List 的指针
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochRemoveHead(struct List *list, struct ListEpoch *epoch)
+{
+    if (list == NULL || epoch == NULL || ListIsEmpty(list)) {
+        return;
+    }
+
+    ListEpochRetire(list, list->base.next, epoch);
+}
+
+/**
+ * @brief 摘除链表尾部元素，宽限期结束后再释放
+ * @param list 指向 List 的指针
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochRemoveTail(struct List *list, struct ListEpoch *epoch)
+{
+    if (list == NULL || epoch == NULL || ListIsEmpty(list)) {
+        return;
+    }
+
+    ListEpochRetire(list, list->base.prev, epoch);
+}
+
+/**
+ * @brief 释放一条待回收链
+ * @param epoch 指向 ListEpoch 的指针
+ * @param slot 待回收链下标
+ */
+static void ListEpochFreeLimbo(struct ListEpoch *epoch, unsigned long slot)
+{
+    struct Node *node = epoch->limbo[slot];
+    struct Node *prev = NULL;
+
+    epoch->limbo[slot] = NULL;
+    while (node != NULL) {
+        prev = node->prev;
+        if (epoch->freeFunc != NULL) {
+            epoch->freeFunc(node);
+        }
+        epoch->limboSize--;
+        node = prev;
+    }
+}
+
+/**
+ * @brief 尝试推进纪元并释放已度过宽限期的节点（非阻塞）
+ *        所有处于临界区的读线程都已进入当前纪元 e 时才能推进到 e + 1，
+ *        此时在 e - 1 纪元摘除的节点已不可能再被任何读线程访问
+ * @param epoch 指向 ListEpoch 的指针
+ * @return true 表示推进成功，false 表示仍有读线程停留在旧纪元
+ */
+bool ListEpochReclaim(struct ListEpoch *epoch)
+{
+    unsigned long cur = 0;
+    unsigned long state = 0;
+    int i = 0;
+
+    if (epoch == NULL) {
+        return false;
+    }
+
+    /* 摘除操作先于读取读线程状态，与 ListEpochReadLock 中的屏障配对 */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    cur = epoch->epoch;
+    for (i = 0; i < LIST_EPOCH_MAX_READERS; i++) {
+        state = __atomic_load_n(&epoch->readers[i].state, __ATOMIC_ACQUIRE);
+        if ((state & 1UL) != 0 && (state >> 1) != cur) {
+            return false;
+        }
+    }
+
+    ListEpochFreeLimbo(epoch, (cur + 2) % 3);
+    __atomic_store_n(&epoch->epoch, cur + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * @brief 等待宽限期结束，返回时此前摘除的节点均已释放
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochSynchronize(struct ListEpoch *epoch)
+{
+    int advanced = 0;
+
+    if (epoch == NULL) {
+        return;
+    }
+
+    /* 连续推进两次纪元，当前纪元摘除的节点才会被释放 */
+    while (advanced < 2) {
+        if (ListEpochReclaim(epoch)) {
+            advanced++;
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief 释放回收域中所有待回收节点及读线程槽位（调用时不得有读线程处于临界区）
+ * @param epoch 指向 ListEpoch 的指针
+ */
+void ListEpochDestroy(struct ListEpoch *epoch)
+{
+    unsigned long i = 0;
+
+    if (epoch == NULL) {
+        return;
+    }
+
+    for (i = 0; i < 3; i++) {
+        ListEpochFreeLimbo(epoch, i);
+    }
+
+    free(epoch->readers);
+    epoch->readers = NULL;
+}
+
+/**
+ * @brief 后台释放线程
+ * @param arg 指向 ListReclaimer 的指针
+ * @return NULL
+ */
+static void *ListReclaimThread(void *arg)
+{
+    struct ListReclaimer *reclaimer = (struct ListReclaimer *)arg;
+
+    while (true) {
+        pthread_mutex_lock(&reclaimer->lock);
+        while (reclaimer->head == NULL && !reclaimer->stopping) {
+            pthread_cond_wait(&reclaimer->cond, &reclaimer->lock);
+        }
+        if (reclaimer->head == NULL) {
+            pthread_mutex_unlock(&reclaimer->lock);
+            break;
+        }
+        pthread_mutex_unlock(&reclaimer->lock);
+
+        ListReclaimStep(reclaimer, LIST_RECLAIM_BUDGET);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 初始化链表延迟释放器
+ * @param reclaimer 指向 ListReclaimer 的指针
+ * @param background true 表示启动后台线程释放，false 表示由 ListReclaimStep 分批释放
+ * @return true 表示成功，false 表示失败
+ */
+bool ListReclaimerInit(struct ListReclaimer *reclaimer, bool background)
+{
+    if (reclaimer == NULL) {
+        return false;
+    }
+
+    reclaimer->head = NULL;
+    reclaimer->tail = NULL;
+    reclaimer->background = false;
+    reclaimer->stopping = false;
+    if (pthread_mutex_init(&reclaimer->lock, NULL) != 0) {
+        return false;
+    }
+    if (pthread_cond_init(&reclaimer->cond, NULL) != 0) {
+        pthread_mutex_destroy(&reclaimer->lock);
+        return false;
+    }
+
+    if (background) {
+        if (pthread_create(&reclaimer->thread, NULL, ListReclaimThread, reclaimer) != 0) {
+            pthread_cond_destroy(&reclaimer->cond);
+            pthread_mutex_destroy(&reclaimer->lock);
+            return false;
+        }
+        reclaimer->background = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 异步释放整个链表，O(1) 摘下所有节点后交给释放器，链表随即变为空链表
+ * @param reclaimer 指向 ListReclaimer 的指针
+ * @param list 指向 List 的指针
+ * @param freeFunc 释放实际节点空间的函数指针
+ */
+void ListFreeAsync(struct ListReclaimer *reclaimer, struct List *list, void (*freeFunc)(struct Node *))
+{
+    struct ListReclaimJob *job = NULL;
+
+    if (reclaimer == NULL || list == NULL || freeFunc == NULL || ListIsEmpty(list)) {
+        return;
+    }
+
+    job = (struct ListReclaimJob *)malloc(sizeof(struct ListReclaimJob));
+    if (job == NULL) {
+        ListFree(list, freeFunc);
+        return;
+    }
+
+    /* 将所有节点整体挂到 job->list 上 */
+    job->list.base.next = list->base.next;
+    job->list.base.prev = list->base.prev;
+    job->list.base.next->prev = &job->list.base;
+    job->list.base.prev->next = &job->list.base;
+    job->list.size = list->size;
+    job->freeFunc = freeFunc;
+    job->next = NULL;
+    ListInit(list);
+
+    pthread_mutex_lock(&reclaimer->lock);
+    if (reclaimer->tail == NULL) {
+        reclaimer->head = job;
+    } else {
+        reclaimer->tail->next = job;
+    }
+    reclaimer->tail = job;
+    pthread_cond_signal(&reclaimer->cond);
+    pthread_mutex_unlock(&reclaimer->lock);
+}
+
+/**
+ * @brief 分批释放延迟释放器中的节点
+ * @param reclaimer 指向 ListReclaimer 的指针
+ * @param budget 本次最多释放的节点个数
+ * @return 本次实际释放的节点个数
+ */
+int ListReclaimStep(struct ListReclaimer *reclaimer, int budget)
+{
+    struct ListReclaimJob *job = NULL;
+    int freed = 0;
+
+    if (reclaimer == NULL) {
+        return 0;
+    }
+
+    while (freed < budget) {
+        pthread_mutex_lock(&reclaimer->lock);
+        job = reclaimer->head;
+        if (job != NULL) {
+            reclaimer->head = job->next;
+            if (reclaimer->head == NULL) {
+                reclaimer->tail = NULL;
+            }
+        }
+        pthread_mutex_unlock(&reclaimer->lock);
+
+        if (job == NULL) {
+            break;
+        }
+
+        while (freed < budget && !ListIsEmpty(&job->list)) {
+            ListRemoveHead(&job->list, job->freeFunc);
+            freed++;
+        }
+
+        if (ListIsEmpty(&job->list)) {
+            free(job);
+            continue;
+        }
+
+        /* 预算用完，未释放完的链表放回队首，下次继续 */
+        pthread_mutex_lock(&reclaimer->lock);
+        job->next = reclaimer->head;
+        reclaimer->head = job;
+        if (reclaimer->tail == NULL) {
+            reclaimer->tail = job;
+        }
+        pthread_mutex_unlock(&reclaimer->lock);
+    }
+
+    return freed;
+}
+
+/**
+ * @brief 停止后台线程并释放所有剩余节点
+ * @param reclaimer 指向 ListReclaimer 的指针
+ */
+void ListReclaimerDestroy(struct ListReclaimer *reclaimer)
+{
+    if (reclaimer == NULL) {
+        return;
+    }
+
+    if (reclaimer->background) {
+        pthread_mutex_lock(&reclaimer->lock);
+        reclaimer->stopping = true;
+        pthread_cond_signal(&reclaimer->cond);
+        pthread_mutex_unlock(&reclaimer->lock);
+        pthread_join(reclaimer->thread, NULL);
+        reclaimer->background = false;
+    }
+
+    while (ListReclaimStep(reclaimer, LIST_RECLAIM_BUDGET) > 0) {
+    }
+
+    pthread_cond_destroy(&reclaimer->cond);
+    pthread_mutex_destroy(&reclaimer->lock);
+}
+
+/**
+ * @brief 合并两条以 NULL 结尾的有序单链（相等时 a 在前，保证稳定）
+ * @param a 第一条有序单链
+ * @param b 第二条有序单链
+ * @param compareFunc 比较函数
+ * @return 合并后的有序单链
+ */
+static struct Node *ListMergeChains(struct Node *a, struct Node *b, int (*compareFunc)(struct Node *, struct Node *))
+{
+    struct Node head;
+    struct Node *tail = &head;
+
+    while (a != NULL && b != NULL) {
+        if (compareFunc(b, a) < 0) {
+            tail->next = b;
+            b = b->next;
+        } else {
+            tail->next = a;
+            a = a->next;
+        }
+        tail = tail->next;
+    }
+
+    tail->next = (a != NULL) ? a : b;
+
+    return head.next;
+}
+
+/**
+ * @brief 自底向上的稳定归并排序，O(n log n)，用于外部排序中的内存有序段
+ * @param list 指向 List 的指针
+ * @param compareFunc 比较函数
+ */
+static void ListMergeSort(struct List *list, int (*compareFunc)(struct Node *, struct Node *))
+{
+    struct Node *pending[64] = { NULL };
+    struct Node *node = NULL;
+    struct Node *next = NULL;
+    struct Node *carry = NULL;
+    struct Node *prev = NULL;
+    int i = 0;
+
+    if (list->size < 2) {
+        return;
+    }
+
+    /* pending[i] 保存长度为 2^i 的有序单链 */
+    list->base.prev->next = NULL;
+    node = list->base.next;
+    while (node != NULL) {
+        next = node->next;
+        node->next = NULL;
+        carry = node;
+        for (i = 0; pending[i] != NULL; i++) {
+            carry = ListMergeChains(pending[i], carry, compareFunc);
+            pending[i] = NULL;
+        }
+        pending[i] = carry;
+        node = next;
+    }
+
+    carry = NULL;
+    for (i = 0; i < 64; i++) {
+        if (pending[i] != NULL) {
+            carry = ListMergeChains(pending[i], carry, compareFunc);
+        }
+    }
+
+    /* 恢复 prev 指针和循环结构 */
+    prev = &list->base;
+    list->base.next = carry;
+    for (node = carry; node != NULL; node = node->next) {
+        node->prev = prev;
+        prev = node;
+    }
+    prev->next = &list->base;
+    list->base.prev = prev;
+}
+
+/**
+ * @brief 初始化外部排序器
+ * @param sorter 指向 ListExtSort 的指针
+ * @param config 排序配置，memoryLimit 为 0 时使用默认预算，tempDir 为 NULL 时使用 /tmp
+ * @return true 表示成功，false 表示失败
+ */
+bool ListExtSortInit(struct ListExtSort *sorter, const struct ListExtSortConfig *config)
+{
+    size_t runLimit = 0;
+    size_t fanIn = 0;
+    size_t bufferBytes = 0;
+
+    if (sorter == NULL || config == NULL || config->compareFunc == NULL || config->serializeFunc == NULL ||
+        config->deserializeFunc == NULL || config->freeFunc == NULL || config->recordSize == 0) {
+        return false;
+    }
+
+    sorter->config = *config;
+    if (sorter->config.memoryLimit == 0) {
+        sorter->config.memoryLimit = LIST_EXT_SORT_MEMORY;
+    }
+    if (sorter->config.tempDir == NULL) {
+        sorter->config.tempDir = "/tmp";
+    }
+    if (sorter->config.nodeSize == 0) {
+        sorter->config.nodeSize = config->recordSize + sizeof(struct Node);
+    }
+
+    /* 内存预算一半用于内存中的有序段，一半用于归并时各有序段的读缓冲区和一个写缓冲区 */
+    runLimit = sorter->config.memoryLimit / 2 / sorter->config.nodeSize;
+    if (runLimit < 1) {
+        runLimit = 1;
+    } else if (runLimit > 0x7fffffff) {
+        runLimit = 0x7fffffff;
+    }
+
+    bufferBytes = LIST_EXT_SORT_IO_BUFFER / config->recordSize * config->recordSize;
+    if (bufferBytes == 0) {
+        bufferBytes = config->recordSize;
+    }
+
+    fanIn = sorter->config.memoryLimit / 2 / bufferBytes;
+    if (fanIn < 3) {
+        fanIn = 2;
+    } else if (fanIn > LIST_EXT_SORT_MAX_FAN_IN) {
+        fanIn = LIST_EXT_SORT_MAX_FAN_IN;
+    } else {
+        fanIn--;
+    }
+
+    sorter->readers = (struct ListExtSortReader *)calloc(fanIn, sizeof(struct ListExtSortReader));
+    sorter->heads = (struct Node **)calloc(fanIn, sizeof(struct Node *));
+    sorter->tree = (int *)malloc(sizeof(int) * fanIn);
+    if (sorter->readers == NULL || sorter->heads == NULL || sorter->tree == NULL) {
+        free(sorter->readers);
+        free(sorter->heads);
+        free(sorter->tree);
+        return false;
+    }
+
+    ListInit(&sorter->run);
+    sorter->runLimit = (int)runLimit;
+    sorter->fanIn = (int)fanIn;
+    sorter->bufferBytes = bufferBytes;
+    sorter->fd = -1;
+    sorter->runs = NULL;
+    sorter->runCount = 0;
+    sorter->runCapacity = 0;
+    sorter->writeBuffer = NULL;
+    sorter->writeUsed = 0;
+    sorter->writeOffset = 0;
+    sorter->readFd = -1;
+    sorter->mergeCount = 0;
+    sorter->finished = false;
+    sorter->error = false;
+
+    return true;
+}
+
+/**
+ * @brief 创建一个临时文件（创建后即删除目录项，关闭时自动回收）
+ * @param sorter 指向 ListExtSort 的指针
+ * @return 文件描述符，失败时返回 -1
+ */
+static int ListExtSortCreateFile(struct ListExtSort *sorter)
+{
+    char path[4096];
+    int fd = -1;
+
+    snprintf(path, sizeof(path), "%s/listsort-XXXXXX", sorter->config.tempDir);
+    fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+
+    return fd;
+}
+
+/**
+ * @brief 将写缓冲区中的记录全部写入文件
+ * @param sorter 指向 ListExtSort 的指针
+ * @param fd 文件描述符
+ * @return true 表示成功，false 表示失败
+ */
+static bool ListExtSortFlush(struct ListExtSort *sorter, int fd)
+{
+    size_t done = 0;
+    ssize_t n = 0;
+
+    while (done < sorter->writeUsed) {
+        n = write(fd, sorter->writeBuffer + done, sorter->writeUsed - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += (size_t)n;
+    }
+
+    sorter->writeUsed = 0;
+    return true;
+}
+
+/**
+ * @brief 序列化节点并追加到写缓冲区，缓冲区满时先写入文件；节点随后被释放
+ * @param sorter 指向 ListExtSort 的指针
+ * @param fd 文件描述符
+ * @param node 节点指针
+ * @return true 表示成功，false 表示失败
+ */
+static bool ListExtSortWrite(struct ListExtSort *sorter, int fd, struct Node *node)
+{
+    if (sorter->writeUsed + sorter->config.recordSize > sorter->bufferBytes && !ListExtSortFlush(sorter, fd)) {
+        sorter->config.freeFunc(node);
+        return false;
+    }
+
+    sorter->config.serializeFunc(node, sorter->writeBuffer + sorter->writeUsed);
+    sorter->config.freeFunc(node);
+    sorter->writeUsed += sorter->config.recordSize;
+    sorter->writeOffset += sorter->config.recordSize;
+
+    return true;
+}
+
+/**
+ * @brief 从有序段中读取下一条记录并重建节点，读缓冲区取空时整块读入
+ * @param sorter 指向 ListExtSort 的指针
+ * @param index 本趟归并中的有序段下标
+ * @return 节点指针，段读完或出错时返回 NULL
+ */
+static struct Node *ListExtSortRead(struct ListExtSort *sorter, int index)
+{
+    struct ListExtSortReader *reader = &sorter->readers[index];
+    struct Node *node = NULL;
+    unsigned long long records = 0;
+    size_t size = 0;
+    size_t done = 0;
+    ssize_t n = 0;
+
+    if (reader->pos == reader->len) {
+        if (reader->left == 0) {
+            return NULL;
+        }
+
+        records = sorter->bufferBytes / sorter->config.recordSize;
+        if (records > reader->left) {
+            records = reader->left;
+        }
+        size = (size_t)records * sorter->config.recordSize;
+        while (done < size) {
+            n = pread(sorter->readFd, reader->buffer + done, size - done, (off_t)(reader->offset + done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                sorter->error = true;
+                return NULL;
+            }
+            done += (size_t)n;
+        }
+
+        reader->offset += size;
+        reader->left -= records;
+        reader->pos = 0;
+        reader->len = size;
+    }
+
+    node = sorter->config.deserializeFunc(reader->buffer + reader->pos);
+    reader->pos += sorter->config.recordSize;
+    if (node == NULL) {
+        sorter->error = true;
+    }
+
+    return node;
+}
+
+/**
+ * @brief 判断有序段 a 的当前节点是否排在有序段 b 之后（读完的段视为无穷大，
+ *        下标 mergeCount 视为无穷小，相等时下标小者优先以保持稳定）
+ * @param sorter 指向 ListExtSort 的指针
+ * @param a 有序段下标
+ * @param b 有序段下标
+ * @return true 表示 a 排在 b 之后
+ */
+static bool ListExtSortAfter(struct ListExtSort *sorter, int a, int b)
+{
+    int result = 0;
+
+    if (b == sorter->mergeCount || a == sorter->mergeCount) {
+        return a != sorter->mergeCount;
+    }
+    if (sorter->heads[a] == NULL || sorter->heads[b] == NULL) {
+        return sorter->heads[a] == NULL && (sorter->heads[b] != NULL || a > b);
+    }
+
+    result = sorter->config.compareFunc(sorter->heads[a], sorter->heads[b]);
+
+    return result > 0 || (result == 0 && a > b);
+}
+
+/**
+ * @brief 有序段 index 的当前节点变化后，沿败者树向上调整，tree[0] 保存胜者
+ * @param sorter 指向 ListExtSort 的指针
+ * @param index 有序段下标
+ */
+static void ListExtSortAdjust(struct ListExtSort *sorter, int index)
+{
+    int parent = (index + sorter->mergeCount) / 2;
+    int winner = index;
+    int tmp = 0;
+
+    while (parent > 0) {
+        if (ListExtSortAfter(sorter, winner, sorter->tree[parent])) {
+            tmp = winner;
+            winner = sorter->tree[parent];
+            sorter->tree[parent] = tmp;
+        }
+        parent /= 2;
+    }
+
+    sorter->tree[0] = winner;
+}
+
+/**
+ * @brief 为 runs[first, first + count) 建立败者树，读入每个有序段的首个节点
+ * @param sorter 指向 ListExtSort 的指针
+ * @param fd 有序段所在文件
+ * @param first 第一个有序段下标
+ * @param count 有序段个数，不超过 fanIn
+ * @return true 表示成功，false 表示失败
+ */
+static bool ListExtSortStart(struct ListExtSort *sorter, int fd, int first, int count)
+{
+    struct ListExtSortReader *reader = NULL;
+    int i = 0;
+
+    sorter->readFd = fd;
+    sorter->mergeCount = count;
+    for (i = 0; i < count; i++) {
+        reader = &sorter->readers[i];
+        if (reader->buffer == NULL) {
+            reader->buffer = (unsigned char *)malloc(sorter->bufferBytes);
+            if (reader->buffer == NULL) {
+                sorter->error = true;
+                return false;
+            }
+        }
+        reader->pos = 0;
+        reader->len = 0;
+        reader->offset = sorter->runs[first + i].offset;
+        reader->left = sorter->runs[first + i].count;
+    }
+
+    for (i = 0; i < count; i++) {
+        sorter->heads[i] = ListExtSortRead(sorter, i);
+        sorter->tree[i] = count;
+    }
+    for (i = count - 1; i >= 0; i--) {
+        ListExtSortAdjust(sorter, i);
+    }
+
+    return !sorter->error;
+}
+
+/**
+ * @brief 取出败者树的胜者节点，并从其有序段补充下一个节点
+ * @param sorter 指向 ListExtSort 的指针
+ * @return 节点指针，全部取完时返回 NULL
+ */
+static struct Node *ListExtSortPop(struct ListExtSort *sorter)
+{
+    struct Node *node = NULL;
+    int winner = sorter->tree[0];
+
+    node = sorter->heads[winner];
+    if (node == NULL) {
+        return NULL;
+    }
+
+    sorter->heads[winner] = ListExtSortRead(sorter, winner);
+    ListExtSortAdjust(sorter, winner);
+
+    return node;
+}
+
+/**
+ * @brief 结束一趟归并，释放败者树中尚未取出的节点
+ * @param sorter 指向 ListExtSort 的指针
+ */
+static void ListExtSortStop(struct ListExtSort *sorter)
+{
+    int i = 0;
+
+    for (i = 0; i < sorter->mergeCount; i++) {
+        if (sorter->heads[i] != NULL) {
+            sorter->config.freeFunc(sorter->heads[i]);
+            sorter->heads[i] = NULL;
+        }
+    }
+    sorter->mergeCount = 0;
+}
+
+/**
+ * @brief 排序内存中的有序段并追加到临时文件末尾
+ * @param sorter 指向 ListExtSort 的指针
+ * @return true 表示成功，false 表示失败
+ */
+static bool ListExtSortSpill(struct ListExtSort *sorter)
+{
+    struct ListExtSortRun *runs = NULL;
+    struct ListExtSortRun *newRun = NULL;
+    struct Node *node = NULL;
+    int capacity = 0;
+
+    if (ListIsEmpty(&sorter->run)) {
+        return true;
+    }
+
+    if (sorter->runCount == sorter->runCapacity) {
+        capacity = sorter->runCapacity == 0 ? 16 : sorter->runCapacity * 2;
+        runs = (struct ListExtSortRun *)realloc(sorter->runs, sizeof(struct ListExtSortRun) * capacity);
+        if (runs == NULL) {
+            return false;
+        }
+        sorter->runs = runs;
+        sorter->runCapacity = capacity;
+    }
+
+    if (sorter->writeBuffer == NULL) {
+        sorter->writeBuffer = (unsigned char *)malloc(sorter->bufferBytes);
+        if (sorter->writeBuffer == NULL) {
+            return false;
+        }
+    }
+    if (sorter->fd < 0) {
+        sorter->fd = ListExtSortCreateFile(sorter);
+        if (sorter->fd < 0) {
+            return false;
+        }
+    }
+
+    ListMergeSort(&sorter->run, sorter->config.compareFunc);
+    newRun = &sorter->runs[sorter->runCount];
+    newRun->offset = sorter->writeOffset;
+    newRun->count = 0;
+    while (!ListIsEmpty(&sorter->run)) {
+        node = sorter->run.base.next;
+        sorter->run.base.next = node->next;
+        node->next->prev = &sorter->run.base;
+        sorter->run.size--;
+        if (!ListExtSortWrite(sorter, sorter->fd, node)) {
+            return false;
+        }
+        newRun->count++;
+    }
+
+    if (!ListExtSortFlush(sorter, sorter->fd)) {
+        return false;
+    }
+    sorter->runCount++;
+
+    return true;
+}
+
+/**
+ * @brief 一趟归并：每 fanIn 个相邻有序段归并成一段写入新文件，随后关闭旧文件。
+ *        只归并相邻的有序段，保持排序稳定；每趟有序段个数缩小为 1 / fanIn
+ * @param sorter 指向 ListExtSort 的指针
+ * @return true 表示成功，false 表示失败
+ */
+static bool ListExtSortMergePass(struct ListExtSort *sorter)
+{
+    struct Node *node = NULL;
+    unsigned long long offset = 0;
+    unsigned long long count = 0;
+    int newCount = 0;
+    int first = 0;
+    int size = 0;
+    int fd = -1;
+
+    fd = ListExtSortCreateFile(sorter);
+    if (fd < 0) {
+        return false;
+    }
+
+    sorter->writeUsed = 0;
+    sorter->writeOffset = 0;
+    for (first = 0; first < sorter->runCount; first += sorter->fanIn) {
+        size = sorter->runCount - first < sorter->fanIn ? sorter->runCount - first : sorter->fanIn;
+        if (!ListExtSortStart(sorter, sorter->fd, first, size)) {
+            break;
+        }
+
+        offset = sorter->writeOffset;
+        count = 0;
+        while ((node = ListExtSortPop(sorter)) != NULL) {
+            if (!ListExtSortWrite(sorter, fd, node)) {
+                sorter->error = true;
+                break;
+            }
+            count++;
+        }
+        ListExtSortStop(sorter);
+        if (sorter->error) {
+            break;
+        }
+
+        /* 新有序段的下标不超过 first，覆盖的都是已读完的旧记录 */
+        sorter->runs[newCount].offset = offset;
+        sorter->runs[newCount].count = count;
+        newCount++;
+    }
+
+    if (sorter->error || !ListExtSortFlush(sorter, fd)) {
+        close(fd);
+        return false;
+    }
+
+    close(sorter->fd);
+    sorter->fd = fd;
+    sorter->runCount = newCount;
+
+    return true;
+}
+
+/**
+ * @brief 向外部排序器中添加节点，节点归排序器所有，内存预算用满时写出一个有序段
+ * @param sorter 指向 ListExtSort 的指针
+ * @param node 节点指针
+ * @return true 表示成功，false 表示写临时文件失败
+ */
+bool ListExtSortAdd(struct ListExtSort *sorter, struct Node *node)
+{
+    if (sorter == NULL || node == NULL || sorter->finished || sorter->error) {
+        return false;
+    }
+
+    ListAddTail(&sorter->run, node);
+    if (sorter->run.size >= sorter->runLimit && !ListExtSortSpill(sorter)) {
+        sorter->error = true;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 将链表中所有节点移入外部排序器，链表随后被置空
+ * @param sorter 指向 ListExtSort 的指针
+ * @param list 指向 List 的指针
+ * @return true 表示成功，false 表示写临时文件失败
+ */
+bool ListExtSortAddList(struct ListExtSort *sorter, struct List *list)
+{
+    struct Node *node = NULL;
+
+    if (sorter == NULL || list == NULL) {
+        return false;
+    }
+
+    while (!ListIsEmpty(list)) {
+        node = list->base.next;
+        list->base.next = node->next;
+        node->next->prev = &list->base;
+        list->size--;
+        if (!ListExtSortAdd(sorter, node)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 结束输入并准备归并输出，有序段多于 fanIn 时先做若干趟中间归并
+ * @param sorter 指向 ListExtSort 的指针
+ * @return true 表示成功，false 表示失败
+ */
+bool ListExtSortFinish(struct ListExtSort *sorter)
+{
+    if (sorter == NULL || sorter->finished || sorter->error) {
+        return false;
+    }
+
+    sorter->finished = true;
+    if (sorter->runCount == 0) {
+        /* 全部数据都在内存中，无需落盘 */
+        ListMergeSort(&sorter->run, sorter->config.compareFunc);
+        return true;
+    }
+
+    if (!ListExtSortSpill(sorter)) {
+        sorter->error = true;
+        return false;
+    }
+
+    while (sorter->runCount > sorter->fanIn) {
+        if (!ListExtSortMergePass(sorter)) {
+            sorter->error = true;
+            return false;
+        }
+    }
+
+    /* 最后一趟不再需要写缓冲区 */
+    free(sorter->writeBuffer);
+    sorter->writeBuffer = NULL;
+
+    return ListExtSortStart(sorter, sorter->fd, 0, sorter->runCount);
+}
+
+/**
+ * @brief 按序取出下一个节点（流式输出），节点归调用方所有
+ * @param sorter 指向 ListExtSort 的指针
+ * @return 节点指针，全部取完或出错时返回 NULL
+ */
+struct Node *ListExtSortNext(struct ListExtSort *sorter)
+{
+    struct Node *node = NULL;
+
+    if (sorter == NULL || !sorter->finished || sorter->error) {
+        return NULL;
+    }
+
+    if (sorter->runCount == 0) {
+        if (ListIsEmpty(&sorter->run)) {
+            return NULL;
+        }
+        node = sorter->run.base.next;
+        sorter->run.base.next = node->next;
+        node->next->prev = &sorter->run.base;
+        sorter->run.size--;
+        return node;
+    }
+
+    return ListExtSortPop(sorter);
+}
+
+/**
+ * @brief 按序取出所有节点并链接到链表尾部
+ * @param sorter 指向 ListExtSort 的指针
+ * @param list 指向 List 的指针
+ * @return true 表示成功，false 表示读取临时文件出错
+ */
+bool ListExtSortToList(struct ListExtSort *sorter, struct List *list)
+{
+    struct Node *node = NULL;
+
+    if (sorter == NULL || list == NULL) {
+        return false;
+    }
+
+    while ((node = ListExtSortNext(sorter)) != NULL) {
+        ListAddTail(list, node);
+    }
+
+    return !sorter->error;
+}
+
+/**
+ * @brief 释放外部排序器，关闭临时文件并释放尚未取出的节点
+ * @param sorter 指向 ListExtSort 的指针
+ */
+void ListExtSortFree(struct ListExtSort *sorter)
+{
+    int i = 0;
+
+    if (sorter == NULL) {
+        return;
+    }
+
+    ListFree(&sorter->run, sorter->config.freeFunc);
+    if (sorter->heads != NULL) {
+        ListExtSortStop(sorter);
+    }
+    if (sorter->fd >= 0) {
+        close(sorter->fd);
+    }
+    if (sorter->readers != NULL) {
+        for (i = 0; i < sorter->fanIn; i++) {
+            free(sorter->readers[i].buffer);
+        }
+    }
+
+    free(sorter->readers);
+    free(sorter->heads);
+    free(sorter->tree);
+    free(sorter->runs);
+    free(sorter->writeBuffer);
+    sorter->readers = NULL;
+    sorter->heads = NULL;
+    sorter->tree = NULL;
+    sorter->runs = NULL;
+    sorter->writeBuffer = NULL;
+    sorter->fd = -1;
+    sorter->runCount = 0;
+    sorter->runCapacity = 0;
+}
+
+/**
+ * @brief 对 (键, 节点) 数组做 LSD 基数排序后按序重新链接链表
+ *        每次处理 8 位，所有键在某一字节上相同时跳过该趟
+ * @param list 指向 List 的指针
+ * @param pairs 已填好键的数组，长度为 list->size
+ * @param keySize 键的有效字节数
+ * @return true 表示成功，false 表示内存不足
+ */
+static bool ListRadixSort(struct List *list, struct ListKeyPair *pairs, int keySize)
+{
+    struct ListKeyPair *tmp = NULL;
+    struct ListKeyPair *src = pairs;
+    struct ListKeyPair *dst = NULL;
+    struct ListKeyPair *swap = NULL;
+    size_t (*counts)[256] = NULL;
+    size_t sum = 0;
+    size_t cnt = 0;
+    struct Node *prev = NULL;
+    int n = list->size;
+    int pass = 0;
+    int i = 0;
+    int shift = 0;
+
+    tmp = (struct ListKeyPair *)malloc(sizeof(struct ListKeyPair) * n);
+    counts = (size_t (*)[256])calloc(keySize, sizeof(size_t) * 256);
+    if (tmp == NULL || counts == NULL) {
+        free(tmp);
+        free(counts);
+        return false;
+    }
+
+    /* 一次遍历得到所有字节的直方图 */
+    for (i = 0; i < n; i++) {
+        for (pass = 0; pass < keySize; pass++) {
+            counts[pass][(pairs[i].key >> (pass * 8)) & 0xff]++;
+        }
+    }
+
+    dst = tmp;
+    for (pass = 0; pass < keySize; pass++) {
+        shift = pass * 8;
+        if (counts[pass][(src[0].key >> shift) & 0xff] == (size_t)n) {
+            continue;
+        }
+
+        sum = 0;
+        for (i = 0; i < 256; i++) {
+            cnt = counts[pass][i];
+            counts[pass][i] = sum;
+            sum += cnt;
+        }
+
+        for (i = 0; i < n; i++) {
+            dst[counts[pass][(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    prev = &list->base;
+    for (i = 0; i < n; i++) {
+        prev->next = src[i].node;
+        src[i].node->prev = prev;
+        prev = src[i].node;
+    }
+    prev->next = &list->base;
+    list->base.prev = prev;
+
+    free(tmp);
+    free(counts);
+
+    return true;
+}
+
+/**
+ * @brief 按节点内嵌的 32/64 位整数键做 LSD 基数排序（稳定，不调用比较函数）
+ * @param list 指向 List 的指针
+ * @param keyOffset 键相对于 Node 的字节偏移，可用 LIST_KEY_OFFSET 获取
+ * @param keySize 键的字节数，4 或 8
+ * @param isSigned 键是否为有符号整数
+ * @return true 表示成功，false 表示参数错误或内存不足（链表保持不变）
+ */
+bool ListSortByKey(struct List *list, long keyOffset, int keySize, bool isSigned)
+{
+    struct ListKeyPair *pairs = NULL;
+    struct Node *node = NULL;
+    unsigned int key32 = 0;
+    unsigned long long key64 = 0;
+    bool ret = false;
+    int i = 0;
+
+    if (list == NULL || (keySize != 4 && keySize != 8)) {
+        return false;
+    }
+
+    if (list->size < 2) {
+        return true;
+    }
+
+    pairs = (struct ListKeyPair *)malloc(sizeof(struct ListKeyPair) * list->size);
+    if (pairs == NULL) {
+        return false;
+    }
+
+    /* 有符号键翻转符号位后即可按无符号顺序排序 */
+    for (node = list->base.next; node != &list->base; node = node->next, i++) {
+        if (keySize == 4) {
+            memcpy(&key32, (char *)node + keyOffset, sizeof(key32));
+            pairs[i].key = isSigned ? (key32 ^ 0x80000000U) : key32;
+        } else {
+            memcpy(&key64, (char *)node + keyOffset, sizeof(key64));
+            pairs[i].key = isSigned ? (key64 ^ 0x8000000000000000ULL) : key64;
+        }
+        pairs[i].node = node;
+    }
+
+    ret = ListRadixSort(list, pairs, keySize);
+    free(pairs);
+
+    return ret;
+}
+
+/**
+ * @brief 按键提取函数返回的无符号 64 位整数键做 LSD 基数排序（稳定，不调用比较函数）
+ * @param list 指向 List 的指针
+ * @param keyFunc 从节点提取键的函数指针
+ * @return true 表示成功，false 表示参数错误或内存不足（链表保持不变）
+ */
+bool ListSortByKeyFunc(struct List *list, unsigned long long (*keyFunc)(struct Node *))
+{
+    struct ListKeyPair *pairs = NULL;
+    struct Node *node = NULL;
+    bool ret = false;
+    int i = 0;
+
+    if (list == NULL || keyFunc == NULL) {
+        return false;
+    }
+
+    if (list->size < 2) {
+        return true;
+    }
+
+    pairs = (struct ListKeyPair *)malloc(sizeof(struct ListKeyPair) * list->size);
+    if (pairs == NULL) {
+        return false;
+    }
+
+    for (node = list->base.next; node != &list->base; node = node->next, i++) {
+        pairs[i].key = keyFunc(node);
+        pairs[i].node = node;
+    }
+
+    ret = ListRadixSort(list, pairs, 8);
+    free(pairs);
+
+    return ret;
+}
+
+#ifdef LIST_TRACE
+static const char *listTraceOpNames[LIST_TRACE_OP_COUNT] = {
+    "ListGet", "ListAddAtIndex", "ListDeleteAtIndex", "ListFree", "ListSort", "ListContains"
+};
+
+static struct ListTraceThread *listTraceThreads = NULL;
+static __thread struct ListTraceThread *listTraceSelf = NULL;
+static pthread_once_t listTraceKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t listTraceKey;
+
+/**
+ * @brief 获取当前时间戳（默认单位为纳秒，定义 LIST_TRACE_RDTSC 时为 CPU 周期）
+ * @return 时间戳
+ */
+unsigned long long ListTraceNow(void)
+{
+#if defined(LIST_TRACE_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief 将耗时映射到直方图档位（对数分段，每段线性细分）
+ * @param value 耗时
+ * @return 档位下标
+ */
+static int ListTraceBucket(unsigned long long value)
+{
+    int shift = 0;
+
+    if (value < LIST_TRACE_SUB_COUNT) {
+        return (int)value;
+    }
+
+    shift = 63 - __builtin_clzll(value) - LIST_TRACE_SUB_BITS;
+    return (shift + 1) * LIST_TRACE_SUB_COUNT + (int)((value >> shift) & (LIST_TRACE_SUB_COUNT - 1));
+}
+
+/**
+ * @brief 获取直方图档位所表示的耗时上界
+ * @param bucket 档位下标
+ * @return 耗时上界
+ */
+static unsigned long long ListTraceBucketValue(int bucket)
+{
+    int shift = 0;
+    unsigned long long sub = 0;
+
+    if (bucket < LIST_TRACE_SUB_COUNT) {
+        return (unsigned long long)bucket;
+    }
+
+    shift = bucket / LIST_TRACE_SUB_COUNT - 1;
+    sub = (unsigned long long)(bucket % LIST_TRACE_SUB_COUNT);
+    return ((LIST_TRACE_SUB_COUNT + sub + 1) << shift) - 1;
+}
+
+/**
+ * @brief 线程退出时的回调，释放直方图的所有权供新线程复用
+ * @param arg 直方图指针
+ */
+static void ListTraceThreadExit(void *arg)
+{
+    struct ListTraceThread *self = (struct ListTraceThread *)arg;
+
+    __atomic_store_n(&self->used, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 创建用于在线程退出时归还直方图的线程私有键
+ */
+static void ListTraceKeyCreate(void)
+{
+    pthread_key_create(&listTraceKey, ListTraceThreadExit);
+}
+
+/**
+ * @brief 获取当前线程的直方图，优先复用空闲直方图，否则创建并注册
+ * @return 直方图指针，内存不足时返回 NULL
+ */
+static struct ListTraceThread *ListTraceThreadGet(void)
+{
+    struct ListTraceThread *self = listTraceSelf;
+    bool expected = false;
+
+    if (self != NULL) {
+        return self;
+    }
+
+    pthread_once(&listTraceKeyOnce, ListTraceKeyCreate);
+
+    /* 优先复用已退出线程留下的直方图，全局链表长度不超过同时存活的线程数 */
+    self = __atomic_load_n(&listTraceThreads, __ATOMIC_ACQUIRE);
+    while (self != NULL) {
+        expected = false;
+        if (__atomic_compare_exchange_n(&self->used, &expected, true, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+        self = self->next;
+    }
+
+    if (self == NULL) {
+        self = (struct ListTraceThread *)calloc(1, sizeof(struct ListTraceThread));
+        if (self == NULL) {
+            return NULL;
+        }
+        self->used = true;
+
+        self->next = __atomic_load_n(&listTraceThreads, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&listTraceThreads, &self->next, self, true,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(listTraceKey, self);
+    listTraceSelf = self;
+    return self;
+}
+
+/**
+ * @brief 计时范围结束时的回调，将耗时记入当前线程的直方图
+ * @param scope 计时范围指针
+ */
+void ListTraceScopeEnd(struct ListTraceScope *scope)
+{
+    struct ListTraceThread *self = ListTraceThreadGet();
+    unsigned long long elapsed = ListTraceNow() - scope->start;
+    unsigned long long *count = NULL;
+
+    if (self == NULL) {
+        return;
+    }
+
+    /* 只有所属线程写入，使用普通存储即可，无需原子读-改-写 */
+    count = &self->counts[scope->op][ListTraceBucket(elapsed)];
+    __atomic_store_n(count, *count + 1, __ATOMIC_RELAXED);
+    if (elapsed > self->max[scope->op]) {
+        __atomic_store_n(&self->max[scope->op], elapsed, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief 汇总所有线程的直方图，获取指定操作的延迟分位数
+ * @param op 操作类型
+ * @param percentile 分位数（0 ~ 100，例如 99.9）
+ * @return 延迟上界，没有样本时返回 0
+ */
+unsigned long long ListTracePercentile(enum ListTraceOp op, double percentile)
+{
+    unsigned long long merged[LIST_TRACE_BUCKETS];
+    struct ListTraceThread *thread = NULL;
+    unsigned long long total = 0;
+    unsigned long long target = 0;
+    unsigned long long seen = 0;
+    unsigned long long max = 0;
+    unsigned long long value = 0;
+    int i = 0;
+
+    if (op < 0 || op >= LIST_TRACE_OP_COUNT) {
+        return 0;
+    }
+
+    for (i = 0; i < LIST_TRACE_BUCKETS; i++) {
+        merged[i] = 0;
+    }
+
+    thread = __atomic_load_n(&listTraceThreads, __ATOMIC_ACQUIRE);
+    while (thread != NULL) {
+        for (i = 0; i < LIST_TRACE_BUCKETS; i++) {
+            merged[i] += __atomic_load_n(&thread->counts[op][i], __ATOMIC_RELAXED);
+        }
+        value = __atomic_load_n(&thread->max[op], __ATOMIC_RELAXED);
+        if (value > max) {
+            max = value;
+        }
+        thread = thread->next;
+    }
+
+    for (i = 0; i < LIST_TRACE_BUCKETS; i++) {
+        total += merged[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    target = (unsigned long long)(total * percentile / 100.0);
+    if (target == 0) {
+        target = 1;
+    }
+
+    /* 档位上界不会超过实际观测到的最大值 */
+    for (i = 0; i < LIST_TRACE_BUCKETS; i++) {
+        seen += merged[i];
+        if (seen >= target) {
+            value = ListTraceBucketValue(i);
+            return value < max ? value : max;
+        }
+    }
+
+    return max;
+}
+
+/**
+ * @brief 输出每种操作的样本数及 p50/p99/p999/max 延迟
+ * @param fp 输出文件指针
+ */
+void ListTraceDump(FILE *fp)
+{
+    struct ListTraceThread *thread = NULL;
+    unsigned long long count = 0;
+    unsigned long long max = 0;
+    unsigned long long value = 0;
+    int op = 0;
+    int i = 0;
+
+    if (fp == NULL) {
+        return;
+    }
+
+    fprintf(fp, "%-20s %12s %12s %12s %12s %12s\n", "op", "count", "p50", "p99", "p999", "max");
+    for (op = 0; op < LIST_TRACE_OP_COUNT; op++) {
+        count = 0;
+        max = 0;
+        thread = __atomic_load_n(&listTraceThreads, __ATOMIC_ACQUIRE);
+        while (thread != NULL) {
+            for (i = 0; i < LIST_TRACE_BUCKETS; i++) {
+                count += __atomic_load_n(&thread->counts[op][i], __ATOMIC_RELAXED);
+            }
+            value = __atomic_load_n(&thread->max[op], __ATOMIC_RELAXED);
+            if (value > max) {
+                max = value;
+            }
+            thread = thread->next;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        fprintf(fp, "%-20s %12llu %12llu %12llu %12llu %12llu\n", listTraceOpNames[op], count,
+                ListTracePercentile((enum ListTraceOp)op, 50.0),
+                ListTracePercentile((enum ListTraceOp)op, 99.0),
+                ListTracePercentile((enum ListTraceOp)op, 99.9), max);
+    }
+}
+
+/**
+ * @brief 清空所有线程的直方图（其他线程同时在记录时结果是近似的：
+ *        所属线程以普通的读-加一-写更新计数，与这里的清零之间没有同步）
+ */
+void ListTraceReset(void)
+{
+    struct ListTraceThread *thread = NULL;
+    int op = 0;
+    int i = 0;
+
+    thread = __atomic_load_n(&listTraceThreads, __ATOMIC_ACQUIRE);
+    while (thread != NULL) {
+        for (op = 0; op < LIST_TRACE_OP_COUNT; op++) {
+            for (i = 0; i < LIST_TRACE_BUCKETS; i++) {
+                __atomic_store_n(&thread->counts[op][i], 0, __ATOMIC_RELAXED);
+            }
+            __atomic_store_n(&thread->max[op], 0, __ATOMIC_RELAXED);
+        }
+        thread = thread->next;
+    }
+}
+#endif